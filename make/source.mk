@@ -40,6 +40,7 @@ COMMON_SRC = \
             drivers/display.c \
             drivers/display_canvas.c \
             drivers/display_font_metadata.c \
+            drivers/dshot_telemetry.c \
             drivers/exti.c \
             drivers/io.c \
             drivers/io_pca9685.c \
@@ -90,6 +91,7 @@ COMMON_SRC = \
             flight/failsafe.c \
             flight/hil.c \
             flight/imu.c \
+            flight/imu_ekf.c \
             flight/mixer.c \
             flight/pid.c \
             flight/pid_autotune.c \
@@ -111,6 +113,7 @@ COMMON_SRC = \
             io/rcdevice.c \
             io/rcdevice_cam.c \
             msp/msp_serial.c \
+            msp/msp_stats.c \
             rx/crsf.c \
             rx/eleres.c \
             rx/fport.c \
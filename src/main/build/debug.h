@@ -75,5 +75,8 @@ typedef enum {
     DEBUG_FFT_TIME,
     DEBUG_FFT_FREQ,
     DEBUG_ERPM,
+    DEBUG_EKF,
+    DEBUG_EKF_NAV,
+    DEBUG_DSHOT_ERPM,
     DEBUG_COUNT
 } debugType_e;
@@ -42,6 +42,7 @@
 #include "cms/cms_menu_osd.h"
 #include "cms/cms_types.h"
 
+#include "common/crc.h"
 #include "common/maths.h"
 #include "common/printf.h"
 #include "common/typeconversion.h"
@@ -80,10 +81,18 @@
 // simultaneously in the tallest supported screen.
 static uint8_t entry_flags[32];
 
+// entry_flags only, next to PRINT_VALUE and PRINT_LABEL
+#define VALUE_DRAWN    (1 << 5)  // Last drawn value is known, skip redrawing it if unchanged
+
 #define IS_PRINTVALUE(p, row) (entry_flags[row] & PRINT_VALUE)
 #define SET_PRINTVALUE(p, row) { entry_flags[row] |= PRINT_VALUE; }
 #define CLR_PRINTVALUE(p, row) { entry_flags[row] &= ~PRINT_VALUE; }
 
+// Hash of the last value drawn at each row, so polled values which didn't
+// change aren't sent to the display again. Valid while VALUE_DRAWN is set,
+// which clearing the screen resets.
+static uint32_t entry_value_key[ARRAYLEN(entry_flags)];
+
 #define IS_PRINTLABEL(p, row) (entry_flags[row] & PRINT_LABEL)
 #define SET_PRINTLABEL(p, row) { entry_flags[row] |= PRINT_LABEL; }
 #define CLR_PRINTLABEL(p, row) { entry_flags[row] &= ~PRINT_LABEL; }
@@ -325,15 +334,21 @@ static void cmsPadToSize(char *buf, int size)
     cmsPadLeftToSize(buf, size);
 }
 
-static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row, uint8_t maxSize)
+static int cmsWriteValue(displayPort_t *pDisplay, uint8_t col, uint8_t row, uint8_t screenRow, const char *text)
 {
-    int colpos;
-    int cnt;
+    const uint32_t key = fnv1a_update_str(FNV1A_OFFSET_BASIS ^ col, text);
+    if ((entry_flags[screenRow] & VALUE_DRAWN) && entry_value_key[screenRow] == key) {
+        return 0;
+    }
+    entry_value_key[screenRow] = key;
+    entry_flags[screenRow] |= VALUE_DRAWN;
+    return displayWrite(pDisplay, col, row, text);
+}
 
+static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row, uint8_t screenRow, uint8_t maxSize)
+{
     cmsPadToSize(buff, maxSize);
-    colpos = rightMenuColumn - maxSize;
-    cnt = displayWrite(pDisplay, colpos, row, buff);
-    return cnt;
+    return cmsWriteValue(pDisplay, rightMenuColumn - maxSize, row, screenRow, buff);
 }
 
 static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t row, uint8_t screenRow)
@@ -353,7 +368,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
     case OME_String:
         if (IS_PRINTVALUE(p, screenRow) && p->data) {
             strncpy(buff, p->data, CMS_DRAW_BUFFER_LEN);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_DRAW_BUFFER_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_DRAW_BUFFER_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -371,7 +386,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
             strncat(buff, ">", CMS_DRAW_BUFFER_LEN);
 
             row = smallScreen ? row - 1 : row;
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, strlen(buff));
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, strlen(buff));
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -384,7 +399,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 strcpy(buff, "NO");
             }
 
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, 3);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, 3);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -398,7 +413,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 strcpy(buff, "NO");
             }
 
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, 3);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, 3);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -408,7 +423,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
             const OSD_TAB_t *ptr = p->data;
             char * str = (char *)ptr->names[*ptr->val];
             strncpy(buff, str, CMS_DRAW_BUFFER_LEN);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_DRAW_BUFFER_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_DRAW_BUFFER_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -423,7 +438,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 val = ptr->val;
             }
             itoa(*val, buff, 10);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -438,7 +453,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 val = ptr->val;
             }
             itoa(*val, buff, 10);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -453,7 +468,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 val = ptr->val;
             }
             itoa(*val, buff, 10);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -468,7 +483,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 val = ptr->val;
             }
             itoa(*val, buff, 10);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -477,7 +492,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
         if (IS_PRINTVALUE(p, screenRow) && p->data) {
             const OSD_FLOAT_t *ptr = p->data;
             cmsFormatFloat(*ptr->val * ptr->multipler, buff);
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -545,7 +560,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                     strcat(buff, suffix);
                 }
             }
-            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, maxSize);
+            cnt = cmsDrawMenuItemValue(pDisplay, buff, row, screenRow, maxSize);
             CLR_PRINTVALUE(p, screenRow);
         }
         break;
@@ -565,8 +580,8 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 }
             }
             if (text) {
-                cnt = displayWrite(pDisplay,
-                        leftMenuColumn + 1 + (uint8_t) strlen(p->text), row, text);
+                cnt = cmsWriteValue(pDisplay,
+                        leftMenuColumn + 1 + (uint8_t) strlen(p->text), row, screenRow, text);
             }
             CLR_PRINTVALUE(p, screenRow);
         }
@@ -1326,6 +1341,8 @@ void cmsUpdate(uint32_t currentTimeUs)
             // Check again, the keypress might have produced a yield
             if (cmsYieldUntil == 0) {
                 cmsDrawMenu(pCurrentDisplay, currentTimeUs);
+                // Displays which buffer writes (e.g. MSP) send them here
+                displayDrawScreen(pCurrentDisplay);
             }
         }
 
@@ -34,3 +34,9 @@ void crc8_xor_sbuf_append(struct sbuf_s *dst, uint8_t *start);
 
 uint8_t crc8(uint8_t crc, uint8_t a);
 uint8_t crc8_update(uint8_t crc, const void *data, uint32_t length);
+
+// FNV-1a, for detecting changes rather than transmission errors
+#define FNV1A_OFFSET_BASIS  2166136261U
+#define FNV1A_PRIME         16777619U
+
+uint32_t fnv1a_update_str(uint32_t hash, const char *str);
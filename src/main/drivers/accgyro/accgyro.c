@@ -77,6 +77,7 @@ const gyroFilterAndRateConfig_t * chooseGyroConfig(uint8_t desiredLpf, uint16_t
 static void gyroIntExtiHandler(extiCallbackRec_t *cb)
 {
     gyroDev_t *gyro = container_of(cb, gyroDev_t, exti);
+    gyro->dataReadyTimeUs = micros();
     gyro->dataReady = true;
     if (gyro->updateFn) {
         gyro->updateFn(gyro);
@@ -19,6 +19,7 @@
 
 #include "platform.h"
 #include "common/axis.h"
+#include "common/time.h"
 #include "drivers/exti.h"
 #include "drivers/sensor.h"
 
@@ -52,6 +53,7 @@ typedef struct gyroDev_s {
     uint8_t lpf;                                        // Configuration value: Hardware LPF setting
     uint32_t requestedSampleIntervalUs;                 // Requested sample interval
     volatile bool dataReady;
+    volatile timeUs_t dataReadyTimeUs;                  // Time of the latest data ready interrupt
     uint32_t sampleRateIntervalUs;                      // Gyro driver should set this to actual sampling rate as signaled by IRQ
     sensor_align_e gyroAlign;
 } gyroDev_t;
@@ -23,6 +23,8 @@
 #include "common/axis.h"
 #include "common/utils.h"
 
+#include "drivers/time.h"
+
 #include "drivers/accgyro/accgyro.h"
 #include "drivers/accgyro/accgyro_fake.h"
 
@@ -60,7 +62,7 @@ static bool fakeGyroReadTemperature(gyroDev_t *gyro, int16_t *temperatureData)
 
 static bool fakeGyroInitStatus(gyroDev_t *gyro)
 {
-    UNUSED(gyro);
+    gyro->dataReadyTimeUs = micros();
     return true;
 }
 
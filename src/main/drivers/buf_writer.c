@@ -16,6 +16,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include "buf_writer.h"
 
@@ -38,6 +39,24 @@ void bufWriterAppend(bufWriter_t *b, uint8_t ch)
     }
 }
 
+void bufWriterAppendData(bufWriter_t *b, const void *data, int count)
+{
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        const int space = b->capacity - b->at;
+        const int chunk = (count < space) ? count : space;
+        memcpy(&b->data[b->at], p, chunk);
+        b->at += chunk;
+        p += chunk;
+        count -= chunk;
+
+        if (b->at >= b->capacity) {
+            bufWriterFlush(b);
+        }
+    }
+}
+
 void bufWriterFlush(bufWriter_t *b)
 {
     if (b->at != 0) {
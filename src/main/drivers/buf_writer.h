@@ -35,4 +35,5 @@ typedef struct bufWriter_s {
 //
 bufWriter_t *bufWriterInit(uint8_t *b, int total_size, bufWrite_t writer, void *p);
 void bufWriterAppend(bufWriter_t *b, uint8_t ch);
+void bufWriterAppendData(bufWriter_t *b, const void *data, int count);
 void bufWriterFlush(bufWriter_t *b);
@@ -46,7 +46,7 @@ PG_RESET_TEMPLATE(displayConfig_t, displayConfig,
     .force_sw_blink = false,
 );
 
-static bool displayAttributesRequireEmulation(displayPort_t *instance, textAttributes_t attr)
+bool displayAttributesRequireEmulation(const displayPort_t *instance, textAttributes_t attr)
 {
     if (attr & ~instance->cachedSupportedTextAttributes) {
         // We only emulate blink for now
@@ -227,6 +227,14 @@ bool displayIsTransferInProgress(const displayPort_t *instance)
     return instance->vTable->isTransferInProgress(instance);
 }
 
+bool displayHasPendingChanges(const displayPort_t *instance)
+{
+    if (instance->vTable->hasPendingChanges) {
+        return instance->vTable->hasPendingChanges(instance);
+    }
+    return false;
+}
+
 void displayHeartbeat(displayPort_t *instance)
 {
     instance->vTable->heartbeat(instance);
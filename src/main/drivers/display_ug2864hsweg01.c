@@ -24,6 +24,9 @@
 
 #ifdef USE_OLED_UG2864
 
+#include "common/bitarray.h"
+#include "common/utils.h"
+
 #include "drivers/bus.h"
 #include "drivers/bus_i2c.h"
 #include "drivers/time.h"
@@ -176,6 +179,22 @@ static const uint8_t multiWiiFont[][5] = { // Refer to "Times New Roman" Font Da
 
 static busDevice_t *busDev = NULL;
 
+// Characters are written to this buffer and sent by i2c_OLED_flush(),
+// only the ones which changed and in one I2C transaction per run of
+// consecutive dirty characters. 0 means the contents on the display
+// are unknown (e.g. after raw bytes were written).
+#define SCREEN_CHARACTER_COUNT (SCREEN_CHARACTER_ROW_COUNT * SCREEN_CHARACTER_COLUMN_COUNT)
+#define SCREEN_CHARACTER_UNKNOWN 0
+// Limits the time the I2C bus is kept busy by a single flush, so
+// sensors sharing it are not starved
+#define MAX_ROWS_PER_FLUSH 2
+
+static char screenBuffer[SCREEN_CHARACTER_COUNT];
+static BITARRAY_DECLARE(screenIsDirty, SCREEN_CHARACTER_COUNT);
+static uint8_t cursorPos;
+// Controller's RAM pointer doesn't match cursorPos, set it before the next raw byte
+static bool rawAddressPending = true;
+
 static bool i2c_OLED_send_cmd(uint8_t command)
 {
     if (!busDev) {
@@ -185,12 +204,29 @@ static bool i2c_OLED_send_cmd(uint8_t command)
     return busWrite(busDev, 0x80, command);
 }
 
+static void i2c_OLED_set_address(uint8_t page, uint8_t column)
+{
+    i2c_OLED_send_cmd(0xb0 + page);                     //set page address
+    i2c_OLED_send_cmd(0x00 + (column & 0x0f));          //set low col address
+    i2c_OLED_send_cmd(0x10 + ((column >> 4) & 0x0f));   //set high col address
+}
+
 bool i2c_OLED_send_byte(uint8_t val)
 {
     if (!busDev) {
         return false;
     }
 
+    // Raw bytes bypass the character buffer. Before the first one send
+    // pending characters, so they don't overwrite these later, and point
+    // the controller at the cursor position.
+    if (rawAddressPending) {
+        while (i2c_OLED_flush());
+        memset(screenBuffer, SCREEN_CHARACTER_UNKNOWN, sizeof(screenBuffer));
+        i2c_OLED_set_address(cursorPos / SCREEN_CHARACTER_COLUMN_COUNT, (cursorPos % SCREEN_CHARACTER_COLUMN_COUNT) * CHARACTER_WIDTH_TOTAL);
+        rawAddressPending = false;
+    }
+
     return busWrite(busDev, 0x40, val);
 }
 
@@ -200,53 +236,54 @@ void i2c_OLED_clear_display(void)
     i2c_OLED_send_cmd(0xae);              // Display OFF
     i2c_OLED_send_cmd(0x20);              // Set Memory Addressing Mode
     i2c_OLED_send_cmd(0x00);              // Set Memory Addressing Mode to Horizontal addressing mode
-    i2c_OLED_send_cmd(0xb0);              // set page address to 0
     i2c_OLED_send_cmd(0x40);              // Display start line register to 0
-    i2c_OLED_send_cmd(0);                 // Set low col address to 0
-    i2c_OLED_send_cmd(0x10);              // Set high col address to 0
-    for (uint16_t i = 0; i < 1024; i++) {  // fill the display's RAM with graphic... 128*64 pixel picture
-        i2c_OLED_send_byte(0x00);  // clear
+    uint8_t zeroes[SCREEN_WIDTH] = { 0 };
+    for (int page = 0; page < SCREEN_HEIGHT / 8; page++) {  // fill the display's RAM with graphic... 128*64 pixel picture
+        i2c_OLED_set_address(page, 0);
+        busWriteBuf(busDev, 0x40, zeroes, sizeof(zeroes));
     }
     i2c_OLED_send_cmd(0x81);              // Setup CONTRAST CONTROL, following byte is the contrast Value... always a 2 byte instruction
     i2c_OLED_send_cmd(200);               // Here you can set the brightness 1 = dull, 255 is very bright
     i2c_OLED_send_cmd(0xaf);              // display on
+
+    // A blank display matches a buffer full of spaces
+    memset(screenBuffer, ' ', sizeof(screenBuffer));
+    BITARRAY_CLR_ALL(screenIsDirty);
+    rawAddressPending = true;
 }
 
 void i2c_OLED_clear_display_quick(void)
 {
-    i2c_OLED_send_cmd(0xb0);              // set page address to 0
-    i2c_OLED_send_cmd(0x40);              // Display start line register to 0
-    i2c_OLED_send_cmd(0);                 // Set low col address to 0
-    i2c_OLED_send_cmd(0x10);              // Set high col address to 0
-    for (uint16_t i = 0; i < 1024; i++) {      // fill the display's RAM with graphic... 128*64 pixel picture
-        i2c_OLED_send_byte(0x00);  // clear
+    // Only characters which are not blank yet get sent
+    for (unsigned ii = 0; ii < ARRAYLEN(screenBuffer); ii++) {
+        if (screenBuffer[ii] != ' ') {
+            screenBuffer[ii] = ' ';
+            bitArraySet(screenIsDirty, ii);
+        }
     }
 }
 
 void i2c_OLED_set_xy(uint8_t col, uint8_t row)
 {
-    i2c_OLED_send_cmd(0xb0 + row);                      //set page address
-    i2c_OLED_send_cmd(0x00 + ((CHARACTER_WIDTH_TOTAL * col) & 0x0f));         //set low col address
-    i2c_OLED_send_cmd(0x10 + (((CHARACTER_WIDTH_TOTAL * col) >> 4) & 0x0f));  //set high col address
+    cursorPos = row * SCREEN_CHARACTER_COLUMN_COUNT + col;
+    rawAddressPending = true;
 }
 
 void i2c_OLED_set_line(uint8_t row)
 {
-    i2c_OLED_send_cmd(0xb0 + row); //set page address
-    i2c_OLED_send_cmd(0);          //set low col address
-    i2c_OLED_send_cmd(0x10);       //set high col address
+    i2c_OLED_set_xy(0, row);
 }
 
 void i2c_OLED_send_char(unsigned char ascii)
 {
-    unsigned char i;
-    uint8_t buffer;
-    for (i = 0; i < 5; i++) {
-        buffer = multiWiiFont[ascii - 32][i];
-        buffer ^= CHAR_FORMAT;  // apply
-        i2c_OLED_send_byte(buffer);
+    if (cursorPos >= SCREEN_CHARACTER_COUNT) {
+        return;
+    }
+    if (screenBuffer[cursorPos] != (char)ascii) {
+        screenBuffer[cursorPos] = ascii;
+        bitArraySet(screenIsDirty, cursorPos);
     }
-    i2c_OLED_send_byte(CHAR_FORMAT);    // the gap
+    cursorPos++;
 }
 
 void i2c_OLED_send_string(const char *string)
@@ -258,6 +295,47 @@ void i2c_OLED_send_string(const char *string)
     }
 }
 
+bool i2c_OLED_flush(void)
+{
+    uint8_t data[SCREEN_CHARACTER_COLUMN_COUNT * CHARACTER_WIDTH_TOTAL];
+    int rows = 0;
+    int lastRow = -1;
+    int pos = 0;
+
+    if (!busDev) {
+        return false;
+    }
+
+    while ((pos = BITARRAY_FIND_FIRST_SET(screenIsDirty, pos)) >= 0) {
+        const int row = pos / SCREEN_CHARACTER_COLUMN_COUNT;
+        const int col = pos % SCREEN_CHARACTER_COLUMN_COUNT;
+        if (row != lastRow) {
+            if (rows == MAX_ROWS_PER_FLUSH) {
+                return true;
+            }
+            rows++;
+            lastRow = row;
+        }
+
+        // Render the run of dirty characters in this row
+        int len = 0;
+        for (int ii = col; ii < SCREEN_CHARACTER_COLUMN_COUNT && bitArrayGet(screenIsDirty, pos); ii++, pos++) {
+            const uint8_t *glyph = multiWiiFont[(uint8_t)screenBuffer[pos] - 32];
+            for (int jj = 0; jj < FONT_WIDTH; jj++) {
+                data[len++] = glyph[jj] ^ CHAR_FORMAT;
+            }
+            data[len++] = CHAR_FORMAT;    // the gap
+            bitArrayClr(screenIsDirty, pos);
+        }
+
+        i2c_OLED_set_address(row, col * CHARACTER_WIDTH_TOTAL);
+        busWriteBuf(busDev, 0x40, data, len);
+        rawAddressPending = true;
+    }
+
+    return false;
+}
+
 /**
 * according to http://www.adafruit.com/datasheets/UG-2864HSWEG01.pdf Chapter 4.4 Page 15
 */
@@ -43,4 +43,5 @@ void i2c_OLED_send_string(const char *string);
 bool i2c_OLED_send_byte(uint8_t val);
 void i2c_OLED_clear_display(void);
 void i2c_OLED_clear_display_quick(void);
+bool i2c_OLED_flush(void);
 
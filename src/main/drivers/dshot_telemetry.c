@@ -0,0 +1,93 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_DSHOT_BIDIR
+
+#include "drivers/dshot_telemetry.h"
+
+// GCR 5b/4b decoding, invalid codes map to 0 and are caught by the checksum
+static const uint8_t dshotGcrDecode[32] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 10, 11, 0, 13, 14, 15,
+    0, 0, 2, 3, 0, 5, 6, 7, 0, 0, 8, 1, 0, 4, 12, 0
+};
+
+bool dshotDecodeTelemetry(const uint32_t * edges, uint32_t count, uint32_t * erpm)
+{
+    uint32_t value = 0;
+    int bits = 0;
+
+    if (count < 2) {
+        return false;
+    }
+
+    // Every edge starts a new run of bits, the line stays high after the last one
+    for (uint32_t i = 1; i <= count && bits < DSHOT_BIDIR_GCR_BITS; i++) {
+        int len;
+        if (i < count) {
+            const uint16_t diff = edges[i] - edges[i - 1];
+            len = (diff + DSHOT_BIDIR_GCR_BITLENGTH / 2) / DSHOT_BIDIR_GCR_BITLENGTH;
+        }
+        else {
+            len = DSHOT_BIDIR_GCR_BITS - bits;
+        }
+
+        if (len <= 0) {
+            return false;
+        }
+
+        value = (value << len) | (1 << (len - 1));
+        bits += len;
+    }
+
+    if (bits != DSHOT_BIDIR_GCR_BITS) {
+        return false;
+    }
+
+    uint32_t packet = dshotGcrDecode[value & 0x1f] |
+                      (dshotGcrDecode[(value >> 5) & 0x1f] << 4) |
+                      (dshotGcrDecode[(value >> 10) & 0x1f] << 8) |
+                      (dshotGcrDecode[(value >> 15) & 0x1f] << 12);
+
+    // Inverted checksum, xor of all nibbles must be 0xf
+    if (((packet ^ (packet >> 4) ^ (packet >> 8) ^ (packet >> 12)) & 0xf) != 0xf) {
+        return false;
+    }
+
+    packet >>= 4;
+
+    // Motor stopped
+    if (packet == 0x0fff) {
+        *erpm = 0;
+        return true;
+    }
+
+    // 9 bit mantissa and 3 bit exponent, eRPM period in microseconds
+    const uint32_t periodUs = (packet & 0x1ff) << (packet >> 9);
+    if (periodUs == 0) {
+        return false;
+    }
+
+    *erpm = (60 * 1000000 + periodUs / 2) / periodUs;
+    return true;
+}
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ESC reply is 21 GCR bits at 5/4 of the DSHOT bitrate, 16 timer ticks per bit
+#define DSHOT_BIDIR_GCR_BITS                21
+#define DSHOT_BIDIR_GCR_BITLENGTH           16
+
+// Decode the captured edge timestamps (timer ticks) of an ESC reply.
+// Returns false if the reply is incomplete or corrupted.
+bool dshotDecodeTelemetry(const uint32_t * edges, uint32_t count, uint32_t * erpm);
@@ -40,6 +40,7 @@
 
 #include "drivers/dma.h"
 #include "drivers/io.h"
+#include "drivers/time.h"
 #include "drivers/timer.h"
 #include "drivers/light_ws2811strip.h"
 
@@ -47,6 +48,10 @@
 #define WS2811_BIT_COMPARE_1 ((WS2811_PERIOD * 2) / 3)
 #define WS2811_BIT_COMPARE_0 (WS2811_PERIOD / 3)
 
+// The strip is sent again after this time even if it didn't change, to
+// recover LEDs which latched a glitch or were powered up later
+#define WS2811_MAX_UPDATE_INTERVAL_MS 1000
+
 static timerDMASafeType_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
 
 static IO_t ws2811IO = IO_NONE;
@@ -54,6 +59,12 @@ static TCH_t * ws2811TCH = NULL;
 static bool ws2811Initialised = false;
 
 static hsvColor_t ledColorBuffer[WS2811_LED_STRIP_LENGTH];
+// Colors currently encoded in ledStripDMABuffer. Only LEDs which differ
+// from these are converted and encoded again, and nothing is sent when
+// no LED changed.
+static hsvColor_t ledColorEncoded[WS2811_LED_STRIP_LENGTH];
+static bool ledColorEncodedValid = false;
+static timeMs_t ledStripLastUpdateMs;
 
 void setLedHsv(uint16_t index, const hsvColor_t *color)
 {
@@ -144,6 +155,11 @@ STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color)
     }
 }
 
+static bool hsvColorEquals(const hsvColor_t *a, const hsvColor_t *b)
+{
+    return a->h == b->h && a->s == b->s && a->v == b->v;
+}
+
 /*
  * This method is non-blocking unless an existing LED update is in progress.
  * it does not wait until all the LEDs have been updated, that happens in the background.
@@ -157,17 +173,31 @@ void ws2811UpdateStrip(void)
         return;
     }
 
-    dmaBufferOffset = 0;                // reset buffer memory index
+    const timeMs_t currentTimeMs = millis();
+    const bool encodeAll = !ledColorEncodedValid || currentTimeMs - ledStripLastUpdateMs >= WS2811_MAX_UPDATE_INTERVAL_MS;
+    bool changed = encodeAll;
+
     ledIndex = 0;                       // reset led index
 
     // fill transmit buffer with correct compare values to achieve
     // correct pulse widths according to color values
     while (ledIndex < WS2811_LED_STRIP_LENGTH)
     {
-        rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
-        fastUpdateLEDDMABuffer(rgb24);
+        if (encodeAll || !hsvColorEquals(&ledColorBuffer[ledIndex], &ledColorEncoded[ledIndex])) {
+            dmaBufferOffset = ledIndex * WS2811_BITS_PER_LED;
+            rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
+            fastUpdateLEDDMABuffer(rgb24);
+            ledColorEncoded[ledIndex] = ledColorBuffer[ledIndex];
+            changed = true;
+        }
         ledIndex++;
     }
+    ledColorEncodedValid = true;
+
+    if (!changed) {
+        return;
+    }
+    ledStripLastUpdateMs = currentTimeMs;
 
     // Initiate hardware transfer
     if (!ws2811Initialised || !ws2811TCH) {
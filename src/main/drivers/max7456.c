@@ -24,7 +24,7 @@
 
 #ifdef USE_MAX7456
 
-#include "common/bitarray.h"
+#include "common/maths.h"
 #include "common/printf.h"
 #include "common/utils.h"
 
@@ -176,14 +176,23 @@
 #define CHAR_MODE_EXT           (1 << 2)
 #define CHAR_MODE_IS_EXT(m)     ((m) & CHAR_MODE_EXT)
 
-// we write everything in osdCharacterGridBuffer and set a dirty bit
-// in screenIsDirty to update only changed chars. This solution
+// we write everything in osdCharacterGridBuffer, which also keeps track
+// of the dirty chars, to update only changed chars. This solution
 // is faster than redrawing the whole screen on each frame.
-static BITARRAY_DECLARE(screenIsDirty, MAX7456_BUFFER_CHARS_PAL);
-
-//max chars to update in one idle
-#define MAX_CHARS2UPDATE        10
+STATIC_ASSERT(MAX7456_CHARS_PER_LINE == OSD_CHARACTER_GRID_MAX_WIDTH, max7456_lines_must_match_osd_grid);
+
+// max SPI bytes to send in one idle. Characters are either sent one
+// by one (DMAH, DMAL, DMDI plus a DMM write when the mode changes) or,
+// for runs of consecutive dirty chars using the same mode, in
+// auto-increment mode (DMAH, DMAL, DMM, a DMDI per char, DMDI with the
+// 0xFF escape and DMM again).
+#define MAX_BYTES2UPDATE        140
 #define BYTES_PER_CHAR2UPDATE   (7 * 2) // SPI regs + values for them
+#define BYTES_PER_RUN2UPDATE    (5 * 2) // Fixed overhead of an auto-increment run
+#define BYTES_PER_RUN_CHAR      (1 * 2)
+// Shorter runs are cheaper to send one by one
+#define MIN_RUN_LENGTH          3
+#define AUTOINCREMENT_ESCAPE    0xFF
 
 typedef struct max7456Registers_s {
     uint8_t vm0;
@@ -354,7 +363,7 @@ static void max7456ReInit(void)
     busTransfer(state.dev, NULL, buf, bufPtr);
 
     // force redrawing all screen
-    BITARRAY_SET_ALL(screenIsDirty);
+    osdCharacterGridBufferSetAllDirty();
     if (!state.isInitialized) {
         max7456RefreshAll();
         state.isInitialized = true;
@@ -409,10 +418,7 @@ void max7456Init(const videoSystem_e videoSystem)
 void max7456ClearScreen(void)
 {
     for (uint_fast16_t ii = 0; ii < ARRAYLEN(osdCharacterGridBuffer); ii++) {
-        if (osdCharacterGridBuffer[ii] != CHAR_BLANK) {
-            osdCharacterGridBuffer[ii] = CHAR_BLANK;
-            bitArraySet(screenIsDirty, ii);
-        }
+        osdCharacterGridBufferWrite(ii, CHAR_BLANK);
     }
 }
 
@@ -420,10 +426,7 @@ void max7456WriteChar(uint8_t x, uint8_t y, uint16_t c, uint8_t mode)
 {
     unsigned pos = y * MAX7456_CHARS_PER_LINE + x;
     uint16_t val = MAKE_CHAR_MODE(c, mode);
-    if (osdCharacterGridBuffer[pos] != val) {
-        osdCharacterGridBuffer[pos] = val;
-        bitArraySet(screenIsDirty, pos);
-    }
+    osdCharacterGridBufferWrite(pos, val);
 }
 
 bool max7456ReadChar(uint8_t x, uint8_t y, uint16_t *c, uint8_t *mode)
@@ -453,25 +456,39 @@ void max7456Write(uint8_t x, uint8_t y, const char *buff, uint8_t mode)
             break;
         }
         c = MAKE_CHAR_MODE_U8(*buff, mode);
-        if (osdCharacterGridBuffer[pos] != c) {
-            osdCharacterGridBuffer[pos] = c;
-            bitArraySet(screenIsDirty, pos);
+        osdCharacterGridBufferWrite(pos, c);
+    }
+}
+
+// Returns the number of chars starting at pos, all of them dirty, which
+// can be sent as an auto-increment run, up to maxLength.
+static unsigned max7456DirtyRunLength(int pos, uint8_t charMode, unsigned maxLength)
+{
+    unsigned length = 0;
+    while (length < maxLength) {
+        uint16_t val = osdCharacterGridBuffer[pos];
+        // 0xFF ends auto-increment mode, so it can't be part of a run
+        if (MODE_BYTE(val) != charMode || CHAR_BYTE(val) == AUTOINCREMENT_ESCAPE) {
+            break;
         }
+        length++;
+        pos++;
     }
+    return length;
 }
 
 // Must be called with the lock held. Returns wether any new characters
 // were drawn.
 static bool max7456DrawScreenPartial(void)
 {
-    uint8_t spiBuff[MAX_CHARS2UPDATE * BYTES_PER_CHAR2UPDATE];
+    uint8_t spiBuff[MAX_BYTES2UPDATE];
     int bufPtr = 0;
     int pos;
-    uint_fast16_t updatedCharCount;
     uint8_t charMode;
 
-    for (pos = 0, updatedCharCount = 0;;) {
-        pos = BITARRAY_FIND_FIRST_SET(screenIsDirty, pos);
+    for (pos = 0;;) {
+        unsigned dirtyLength;
+        pos = osdCharacterGridBufferFindDirtySpan(pos, &dirtyLength);
         if (pos < 0) {
             // No more dirty chars.
             break;
@@ -484,6 +501,9 @@ static bool max7456DrawScreenPartial(void)
         charMode = MODE_BYTE(osdCharacterGridBuffer[pos]);
         uint8_t chr = CHAR_BYTE(osdCharacterGridBuffer[pos]);
         if (CHAR_MODE_IS_EXT(charMode)) {
+            if (bufPtr + BYTES_PER_CHAR2UPDATE > MAX_BYTES2UPDATE) {
+                break;
+            }
             if (!DMM_IS_8BIT_MODE(state.registers.dmm)) {
                 state.registers.dmm |= DMM_8BIT_MODE;
                 bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMM, state.registers.dmm);
@@ -502,25 +522,50 @@ static bool max7456DrawScreenPartial(void)
             bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMAL, pl);
             bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMDI, chr);
 
-        } else {
-            if (DMM_IS_8BIT_MODE(state.registers.dmm) || (DMM_CHAR_MODE_MASK & state.registers.dmm) != charMode) {
-                state.registers.dmm &= ~DMM_8BIT_MODE;
-                state.registers.dmm = (state.registers.dmm & ~DMM_CHAR_MODE_MASK) | charMode;
-                // Send the attributes for the character run. They
-                // will be applied to all characters until we change
-                // the DMM register.
-                bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMM, state.registers.dmm);
-            }
+            osdCharacterGridBufferClearDirty(pos);
+            pos++;
+            continue;
+        }
+
+        unsigned runLength = 0;
+        if (bufPtr + BYTES_PER_RUN2UPDATE + MIN_RUN_LENGTH * BYTES_PER_RUN_CHAR <= MAX_BYTES2UPDATE) {
+            runLength = max7456DirtyRunLength(pos, charMode, MIN(dirtyLength, (unsigned)(MAX_BYTES2UPDATE - bufPtr - BYTES_PER_RUN2UPDATE) / BYTES_PER_RUN_CHAR));
+        }
+
+        if (runLength >= MIN_RUN_LENGTH) {
+            // The char mode for the whole run comes from DMM
+            state.registers.dmm = (state.registers.dmm & ~(DMM_8BIT_MODE | DMM_CHAR_MODE_MASK)) | charMode;
 
             bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMAH, ph);
             bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMAL, pl);
-            bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMDI, chr);
+            bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMM, state.registers.dmm | DMM_AUTOINCREMENT);
+            for (unsigned ii = 0; ii < runLength; ii++, pos++) {
+                bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMDI, CHAR_BYTE(osdCharacterGridBuffer[pos]));
+                osdCharacterGridBufferClearDirty(pos);
+            }
+            bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMDI, AUTOINCREMENT_ESCAPE);
+            bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+            continue;
         }
 
-        bitArrayClr(screenIsDirty, pos);
-        if (++updatedCharCount == MAX_CHARS2UPDATE) {
+        if (bufPtr + BYTES_PER_CHAR2UPDATE > MAX_BYTES2UPDATE) {
             break;
         }
+
+        if (DMM_IS_8BIT_MODE(state.registers.dmm) || (DMM_CHAR_MODE_MASK & state.registers.dmm) != charMode) {
+            state.registers.dmm &= ~DMM_8BIT_MODE;
+            state.registers.dmm = (state.registers.dmm & ~DMM_CHAR_MODE_MASK) | charMode;
+            // Send the attributes for the character run. They
+            // will be applied to all characters until we change
+            // the DMM register.
+            bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+        }
+
+        bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMAH, ph);
+        bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMAL, pl);
+        bufPtr = max7456PrepareBuffer(spiBuff, bufPtr, MAX7456ADD_DMDI, chr);
+
+        osdCharacterGridBufferClearDirty(pos);
         // Start next search at next bit
         pos++;
     }
@@ -619,10 +664,10 @@ void max7456RefreshAll(void)
         }
 
         // Mark non-blank characters as dirty
-        BITARRAY_CLR_ALL(screenIsDirty);
+        osdCharacterGridBufferClearAllDirty();
         for (unsigned ii = 0; ii < ARRAYLEN(osdCharacterGridBuffer); ii++) {
             if (!CHAR_IS_BLANK(osdCharacterGridBuffer[ii])) {
-                bitArraySet(screenIsDirty, ii);
+                osdCharacterGridBufferSetDirty(ii);
             }
         }
 
@@ -23,10 +23,25 @@
  *
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/bitarray.h"
+
 #include "drivers/display_canvas.h"
 #include "drivers/osd.h"
 
 uint16_t osdCharacterGridBuffer[OSD_CHARACTER_GRID_BUFFER_SIZE] ALIGNED(4);
+// Entries which changed since the backend last sent them to the device
+static BITARRAY_DECLARE(osdCharacterGridDirty, OSD_CHARACTER_GRID_BUFFER_SIZE);
+
+// While a frame is being composed, entries which go from clean to dirty keep
+// the value the device shows in osdCharacterGridFront. On commit, entries which
+// end the frame with that value (e.g. erased and then redrawn) are clean again,
+// so only the net changes of the frame are sent to the device.
+static uint16_t osdCharacterGridFront[OSD_CHARACTER_GRID_BUFFER_SIZE];
+static BITARRAY_DECLARE(osdCharacterGridFrameChanged, OSD_CHARACTER_GRID_BUFFER_SIZE);
+static bool osdCharacterGridFrameActive;
 
 void osdCharacterGridBufferClear(void)
 {
@@ -102,3 +117,90 @@ uint16_t *osdCharacterGridBufferGetEntryPtr(unsigned x, unsigned y)
     unsigned pos = y * OSD_CHARACTER_GRID_MAX_WIDTH + x;
     return &osdCharacterGridBuffer[pos];
 }
+
+bool osdCharacterGridBufferWrite(unsigned pos, uint16_t val)
+{
+    if (pos >= OSD_CHARACTER_GRID_BUFFER_SIZE || osdCharacterGridBuffer[pos] == val) {
+        return false;
+    }
+    if (osdCharacterGridFrameActive && !bitArrayGet(osdCharacterGridDirty, pos)) {
+        osdCharacterGridFront[pos] = osdCharacterGridBuffer[pos];
+        bitArraySet(osdCharacterGridFrameChanged, pos);
+    }
+    osdCharacterGridBuffer[pos] = val;
+    bitArraySet(osdCharacterGridDirty, pos);
+    return true;
+}
+
+void osdCharacterGridBufferSetDirty(unsigned pos)
+{
+    // Device contents are unknown, the entry must be sent
+    bitArrayClr(osdCharacterGridFrameChanged, pos);
+    bitArraySet(osdCharacterGridDirty, pos);
+}
+
+void osdCharacterGridBufferClearDirty(unsigned pos)
+{
+    bitArrayClr(osdCharacterGridFrameChanged, pos);
+    bitArrayClr(osdCharacterGridDirty, pos);
+}
+
+void osdCharacterGridBufferSetAllDirty(void)
+{
+    BITARRAY_CLR_ALL(osdCharacterGridFrameChanged);
+    BITARRAY_SET_ALL(osdCharacterGridDirty);
+}
+
+void osdCharacterGridBufferClearAllDirty(void)
+{
+    BITARRAY_CLR_ALL(osdCharacterGridFrameChanged);
+    BITARRAY_CLR_ALL(osdCharacterGridDirty);
+}
+
+void osdCharacterGridBufferBeginFrame(void)
+{
+    osdCharacterGridFrameActive = true;
+    BITARRAY_CLR_ALL(osdCharacterGridFrameChanged);
+}
+
+void osdCharacterGridBufferCommitFrame(void)
+{
+    int pos = BITARRAY_FIND_FIRST_SET(osdCharacterGridFrameChanged, 0);
+    while (pos >= 0) {
+        if (osdCharacterGridBuffer[pos] == osdCharacterGridFront[pos]) {
+            bitArrayClr(osdCharacterGridDirty, pos);
+        }
+        if (pos + 1 >= OSD_CHARACTER_GRID_BUFFER_SIZE) {
+            break;
+        }
+        pos = BITARRAY_FIND_FIRST_SET(osdCharacterGridFrameChanged, pos + 1);
+    }
+    BITARRAY_CLR_ALL(osdCharacterGridFrameChanged);
+    osdCharacterGridFrameActive = false;
+}
+
+bool osdCharacterGridBufferHasDirty(void)
+{
+    return BITARRAY_FIND_FIRST_SET(osdCharacterGridDirty, 0) >= 0;
+}
+
+bool osdCharacterGridBufferIsDirty(unsigned pos)
+{
+    return bitArrayGet(osdCharacterGridDirty, pos);
+}
+
+int osdCharacterGridBufferFindDirtySpan(unsigned start, unsigned *length)
+{
+    int pos = BITARRAY_FIND_FIRST_SET(osdCharacterGridDirty, start);
+    if (pos < 0) {
+        return -1;
+    }
+    // Spans never cross the end of a row
+    unsigned rowEnd = (pos / OSD_CHARACTER_GRID_MAX_WIDTH + 1) * OSD_CHARACTER_GRID_MAX_WIDTH;
+    unsigned end = pos + 1;
+    while (end < rowEnd && bitArrayGet(osdCharacterGridDirty, end)) {
+        end++;
+    }
+    *length = end - pos;
+    return pos;
+}
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "common/utils.h"
@@ -72,3 +73,28 @@ void osdCharacterGridBufferClear(void);
 void osdGridBufferClearGridRect(int x, int y, int w, int h);
 void osdGridBufferClearPixelRect(displayCanvas_t *canvas, int x, int y, int w, int h);
 uint16_t *osdCharacterGridBufferGetEntryPtr(unsigned x, unsigned y);
+
+// Dirty tracking for backends which keep the screen contents in the grid
+// buffer and send the changed entries to the device later. Positions are
+// y * OSD_CHARACTER_GRID_MAX_WIDTH + x.
+
+// Stores val and marks the entry dirty if it changed. Returns wether it changed.
+bool osdCharacterGridBufferWrite(unsigned pos, uint16_t val);
+void osdCharacterGridBufferSetDirty(unsigned pos);
+void osdCharacterGridBufferClearDirty(unsigned pos);
+void osdCharacterGridBufferSetAllDirty(void);
+void osdCharacterGridBufferClearAllDirty(void);
+bool osdCharacterGridBufferIsDirty(unsigned pos);
+// Returns wether any entry still has to be sent to the device
+bool osdCharacterGridBufferHasDirty(void);
+// Returns the first dirty position >= start, or -1 if there are none. The
+// number of consecutive dirty entries from there up to the end of its row
+// is stored in length.
+int osdCharacterGridBufferFindDirtySpan(unsigned start, unsigned *length);
+// Writes between BeginFrame() and CommitFrame() are treated as a single
+// update: entries which end up with the value they had when the frame
+// started don't stay dirty, so the backend only sends the net changes.
+// Backends report pending changes from displayHasPendingChanges(), so the
+// next frame isn't composed before the previous one reached the device.
+void osdCharacterGridBufferBeginFrame(void);
+void osdCharacterGridBufferCommitFrame(void);
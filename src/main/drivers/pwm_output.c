@@ -27,6 +27,7 @@
 #include "common/log.h"
 #include "common/maths.h"
 
+#include "drivers/dshot_telemetry.h"
 #include "drivers/io.h"
 #include "drivers/timer.h"
 #include "drivers/pwm_mapping.h"
@@ -59,6 +60,13 @@
 #define DSHOT_DMA_BUFFER_SIZE   18 /* resolution + frame reset (2us) */
 #endif
 
+#ifdef USE_DSHOT_BIDIR
+#define DSHOT_BIDIR_REPLY_DELAY_US          30
+#define DSHOT_BIDIR_CAPTURE_BUFFER_SIZE     (DSHOT_BIDIR_GCR_BITS + 3)
+
+STATIC_ASSERT(sizeof(timerDMASafeType_t) == sizeof(uint32_t), dshot_bidir_capture_must_be_32bit);
+#endif
+
 typedef void (*pwmWriteFuncPtr)(uint8_t index, uint16_t value);  // function pointer used to write motors
 
 typedef struct {
@@ -75,12 +83,20 @@ typedef struct {
     // DSHOT parameters
     timerDMASafeType_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE];
 #endif
+
+#ifdef USE_DSHOT_BIDIR
+    bool bidirectional;
+    timerDMASafeType_t dmaInputBuffer[DSHOT_BIDIR_CAPTURE_BUFFER_SIZE];
+#endif
 } pwmOutputPort_t;
 
 typedef struct {
     pwmOutputPort_t *   pwmPort;        // May be NULL if motor doesn't use the PWM port
     uint16_t            value;          // Used to keep track of last motor value
     bool                requestTelemetry;
+#ifdef USE_DSHOT_BIDIR
+    uint32_t            erpm;           // Last valid eRPM reported by the ESC
+#endif
 } pwmOutputMotor_t;
 
 static pwmOutputPort_t pwmOutputPorts[MAX_PWM_OUTPUT_PORTS];
@@ -95,6 +111,11 @@ static pwmWriteFuncPtr         servoWritePtr = NULL;    // Function to write val
 #if defined(USE_DSHOT) || defined(USE_SERIALSHOT)
 static timeUs_t digitalMotorUpdateIntervalUs = 0;
 static timeUs_t digitalMotorLastUpdateUs;
+static timeUs_t digitalMotorFrameStartUs;   // Time the last frame went out, after the DMA buffers were built
+#endif
+
+#ifdef USE_DSHOT_BIDIR
+static bool dshotBidirectional = false;
 #endif
 
 #ifdef BEEPER_PWM
@@ -132,6 +153,9 @@ static pwmOutputPort_t *pwmOutAllocatePort(void)
 
     p->tch = NULL;
     p->configured = false;
+#ifdef USE_DSHOT_BIDIR
+    p->bidirectional = false;
+#endif
 
     return p;
 }
@@ -259,31 +283,44 @@ static pwmOutputPort_t * motorConfigDshot(const timerHardware_t * timerHardware,
         // Only mark as DSHOT channel if DMA was set successfully
         memset(port->dmaBuffer, 0, sizeof(port->dmaBuffer));
         port->configured = true;
+
+#ifdef USE_DSHOT_BIDIR
+        // ESC replies on the same wire, the line idles high between frames
+        if (dshotBidirectional && enableOutput && timerPWMConfigDMAInput(port->tch, port->dmaInputBuffer, DSHOT_BIDIR_CAPTURE_BUFFER_SIZE)) {
+            IOConfigGPIOAF(IOGetByTag(timerHardware->tag), IOCFG_AF_PP_UP, timerHardware->alternateFunction);
+            port->bidirectional = true;
+        }
+#endif
     }
 
     return port;
 }
 
+#define DSHOT_BIT(nibble, bit)  (((nibble) & (1 << (bit))) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0)
+#define DSHOT_NIBBLE(nibble)    { DSHOT_BIT(nibble, 3), DSHOT_BIT(nibble, 2), DSHOT_BIT(nibble, 1), DSHOT_BIT(nibble, 0) }
+
+// DMA buffer contents for each nibble of the packet, MSB first
+static const timerDMASafeType_t dshotNibbleBits[16][4] = {
+    DSHOT_NIBBLE(0),  DSHOT_NIBBLE(1),  DSHOT_NIBBLE(2),  DSHOT_NIBBLE(3),
+    DSHOT_NIBBLE(4),  DSHOT_NIBBLE(5),  DSHOT_NIBBLE(6),  DSHOT_NIBBLE(7),
+    DSHOT_NIBBLE(8),  DSHOT_NIBBLE(9),  DSHOT_NIBBLE(10), DSHOT_NIBBLE(11),
+    DSHOT_NIBBLE(12), DSHOT_NIBBLE(13), DSHOT_NIBBLE(14), DSHOT_NIBBLE(15),
+};
+
 static void loadDmaBufferDshot(timerDMASafeType_t *dmaBuffer, uint16_t packet)
 {
-    for (int i = 0; i < 16; i++) {
-        dmaBuffer[i] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
-        packet <<= 1;
+    for (int i = 0; i < 4; i++) {
+        memcpy(&dmaBuffer[i * 4], dshotNibbleBits[packet >> 12], sizeof(dshotNibbleBits[0]));
+        packet <<= 4;
     }
 }
 
-static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry)
+static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry, bool bidirectional)
 {
     uint16_t packet = (value << 1) | (requestTelemetry ? 1 : 0);
 
-    // compute checksum
-    int csum = 0;
-    int csum_data = packet;
-    for (int i = 0; i < 3; i++) {
-        csum ^=  csum_data;   // xor data by nibbles
-        csum_data >>= 4;
-    }
-    csum &= 0xf;
+    // compute checksum, xor of the data nibbles. Bidirectional ESCs expect it inverted
+    const int csum = (packet ^ (packet >> 4) ^ (packet >> 8) ^ (bidirectional ? 0xf : 0)) & 0xf;
 
     // append checksum
     packet = (packet << 4) | csum;
@@ -292,6 +329,37 @@ static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry)
 }
 #endif
 
+#ifdef USE_DSHOT_BIDIR
+static void pwmUpdateMotorERPM(int index)
+{
+    pwmOutputPort_t * port = motors[index].pwmPort;
+    const uint32_t count = timerPWMGetDMAInputCount(port->tch);
+    uint32_t erpm;
+
+    if (count && dshotDecodeTelemetry(port->dmaInputBuffer, count, &erpm)) {
+        motors[index].erpm = erpm;
+
+        if (index < 4) {
+            DEBUG_SET(DEBUG_DSHOT_ERPM, index, erpm / 100);
+        }
+    }
+}
+
+bool isMotorProtocolDshotBidirectional(void)
+{
+    // Only set when the motors were initialized with a DSHOT protocol
+    return dshotBidirectional;
+}
+
+uint32_t pwmGetMotorERPM(int motorIndex)
+{
+    if (motorIndex < 0 || motorIndex >= MAX_MOTORS) {
+        return 0;
+    }
+    return motors[motorIndex].erpm;
+}
+#endif
+
 #if defined(USE_DSHOT) || defined(USE_SERIALSHOT)
 static void motorConfigDigitalUpdateInterval(uint16_t motorPwmRateHz)
 {
@@ -333,11 +401,11 @@ void pwmRequestMotorTelemetry(int motorIndex)
     }
 }
 
-void pwmCompleteMotorUpdate(void)
+bool pwmCompleteMotorUpdate(void)
 {
     // This only makes sense for digital motor protocols
     if (!isMotorProtocolDigital()) {
-        return;
+        return false;
     }
 
     int motorCount = getMotorCount();
@@ -349,7 +417,7 @@ void pwmCompleteMotorUpdate(void)
 
     // Enforce motor update rate
     if ((digitalMotorUpdateIntervalUs == 0) || ((currentTimeUs - digitalMotorLastUpdateUs) <= digitalMotorUpdateIntervalUs)) {
-        return;
+        return false;
     }
 
     digitalMotorLastUpdateUs = currentTimeUs;
@@ -359,7 +427,15 @@ void pwmCompleteMotorUpdate(void)
         // Generate DMA buffers
         for (int index = 0; index < motorCount; index++) {
             if (motors[index].pwmPort && motors[index].pwmPort->configured) {
-                uint16_t packet = prepareDshotPacket(motors[index].value, motors[index].requestTelemetry);
+                bool bidirectional = false;
+#ifdef USE_DSHOT_BIDIR
+                // Previous frame's reply must be read before the channel goes back to output
+                if (motors[index].pwmPort->bidirectional) {
+                    pwmUpdateMotorERPM(index);
+                    bidirectional = true;
+                }
+#endif
+                uint16_t packet = prepareDshotPacket(motors[index].value, motors[index].requestTelemetry, bidirectional);
                 loadDmaBufferDshot(motors[index].pwmPort->dmaBuffer, packet);
                 timerPWMPrepareDMA(motors[index].pwmPort->tch, DSHOT_DMA_BUFFER_SIZE);
                 motors[index].requestTelemetry = false;
@@ -367,6 +443,7 @@ void pwmCompleteMotorUpdate(void)
         }
 
         // Start DMA on all timers
+        digitalMotorFrameStartUs = micros();
         for (int index = 0; index < motorCount; index++) {
             if (motors[index].pwmPort && motors[index].pwmPort->configured) {
                 timerPWMStartDMA(motors[index].pwmPort->tch);
@@ -381,9 +458,17 @@ void pwmCompleteMotorUpdate(void)
             serialshotUpdateMotor(index, motors[index].value);
         }
 
+        digitalMotorFrameStartUs = micros();
         serialshotSendUpdate();
     }
 #endif
+
+    return true;
+}
+
+timeUs_t pwmGetMotorFrameStartTime(void)
+{
+    return digitalMotorFrameStartUs;
 }
 #endif
 
@@ -420,6 +505,16 @@ void pwmMotorPreconfigure(void)
             escSensorInitialize();
 #endif
             motorConfigDigitalUpdateInterval(motorConfig()->motorPwmRate);
+#ifdef USE_DSHOT_BIDIR
+            dshotBidirectional = motorConfig()->dshotBidir;
+            if (dshotBidirectional) {
+                // Frame, ESC turnaround and reply have to fit between two updates
+                const uint32_t dshotHz = getDshotHz(initMotorProtocol);
+                const uint32_t frameTicks = DSHOT_DMA_BUFFER_SIZE * DSHOT_MOTOR_BITLENGTH + DSHOT_BIDIR_GCR_BITS * DSHOT_BIDIR_GCR_BITLENGTH;
+                const timeUs_t minIntervalUs = frameTicks * 1000000 / dshotHz + 2 * DSHOT_BIDIR_REPLY_DELAY_US;
+                digitalMotorUpdateIntervalUs = MAX(digitalMotorUpdateIntervalUs, minIntervalUs);
+            }
+#endif
             motorWritePtr = pwmWriteDigital;
             break;
 #endif
@@ -26,8 +26,11 @@ ioTag_t pwmGetMotorPinTag(int motorIndex);
 
 void pwmWriteMotor(uint8_t index, uint16_t value);
 void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
-void pwmCompleteMotorUpdate(void);
+bool pwmCompleteMotorUpdate(void);
+timeUs_t pwmGetMotorFrameStartTime(void);
 bool isMotorProtocolDigital(void);
+bool isMotorProtocolDshotBidirectional(void);
+uint32_t pwmGetMotorERPM(int motorIndex);
 
 void pwmWriteServo(uint8_t index, uint16_t value);
 
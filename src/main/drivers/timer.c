@@ -267,3 +267,15 @@ bool timerPWMDMAInProgress(TCH_t * tch)
 {
     return tch->dmaState != TCH_DMA_IDLE;
 }
+
+#ifdef USE_DSHOT_BIDIR
+bool timerPWMConfigDMAInput(TCH_t * tch, void * dmaInputBuffer, uint32_t dmaInputBufferElementCount)
+{
+    return impl_timerPWMConfigDMAInput(tch, dmaInputBuffer, dmaInputBufferElementCount);
+}
+
+uint32_t timerPWMGetDMAInputCount(TCH_t * tch)
+{
+    return impl_timerPWMGetDMAInputCount(tch);
+}
+#endif
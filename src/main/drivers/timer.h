@@ -118,6 +118,11 @@ typedef struct TCH_s {
     DMA_t                           dma;            // Timer channel DMA handle
     volatile tchDmaState_e          dmaState;
     void *                          dmaBuffer;
+#ifdef USE_DSHOT_BIDIR
+    void *                          dmaInputBuffer;     // Edge timestamps are captured here after each output transfer
+    uint32_t                        dmaInputBufferElementCount;
+    volatile bool                   dmaInputActive;
+#endif
 } TCH_t;
 
 // Run-time timer context (dynamically allocated), includes 4x TCH
@@ -127,6 +132,9 @@ typedef struct timHardwareContext_s {
     TIM_HandleTypeDef * timHandle;
 #endif
     TCH_t               ch[CC_CHANNELS_PER_TIMER];
+#ifdef USE_DSHOT_BIDIR
+    uint32_t            dmaOutputPeriod;                // ARR value to restore after capturing, 0 if not capturing
+#endif
 } timHardwareContext_t;
 
 #if defined(STM32F3)
@@ -199,6 +207,14 @@ void timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount);
 void timerPWMStartDMA(TCH_t * tch);
 void timerPWMStopDMA(TCH_t * tch);
 bool timerPWMDMAInProgress(TCH_t * tch);
+#ifdef USE_DSHOT_BIDIR
+// After each DMA output transfer switch the channel to input capture on
+// both edges and store the edge timestamps in dmaInputBuffer, until the
+// next timerPWMPrepareDMA(). The output is inverted (idles high) to match.
+bool timerPWMConfigDMAInput(TCH_t * tch, void * dmaInputBuffer, uint32_t dmaInputBufferElementCount);
+// Number of edges captured since the last output transfer
+uint32_t timerPWMGetDMAInputCount(TCH_t * tch);
+#endif
 
 volatile timCCR_t *timerCCR(TCH_t * tch);
 
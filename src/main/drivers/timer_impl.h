@@ -59,3 +59,7 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
 void impl_timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount);
 void impl_timerPWMStartDMA(TCH_t * tch);
 void impl_timerPWMStopDMA(TCH_t * tch);
+#ifdef USE_DSHOT_BIDIR
+bool impl_timerPWMConfigDMAInput(TCH_t * tch, void * dmaInputBuffer, uint32_t dmaInputBufferElementCount);
+uint32_t impl_timerPWMGetDMAInputCount(TCH_t * tch);
+#endif
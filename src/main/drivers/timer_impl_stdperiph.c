@@ -208,7 +208,13 @@ void impl_timerCaptureCompareHandler(TIM_TypeDef *tim, timHardwareContext_t *tim
 
 void impl_timerPWMConfigChannel(TCH_t * tch, uint16_t value)
 {
-    const bool inverted = tch->timHw->output & TIMER_OUTPUT_INVERTED;
+    bool inverted = tch->timHw->output & TIMER_OUTPUT_INVERTED;
+#ifdef USE_DSHOT_BIDIR
+    // Bidirectional outputs idle high
+    if (tch->dmaInputBuffer) {
+        inverted = !inverted;
+    }
+#endif
 
     TIM_OCInitTypeDef  TIM_OCInitStructure;
 
@@ -272,6 +278,122 @@ void impl_timerChCaptureCompareEnable(TCH_t * tch, bool enable)
     TIM_CCxCmd(tch->timHw->tim, lookupTIMChannelTable[tch->timHw->channelIndex], (enable ? TIM_CCx_Enable : TIM_CCx_Disable));
 }
 
+#ifdef USE_DSHOT_BIDIR
+static void impl_timerDMAConfigureInput(TCH_t * tch)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(tch->dma->ref);
+    DMA_StructInit(&DMA_InitStructure);
+
+    DMA_InitStructure.DMA_Channel = dmaGetChannelByTag(tch->timHw->dmaTag);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)impl_timerCCR(tch);
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)tch->dmaInputBuffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = tch->dmaInputBufferElementCount;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+
+    // No TC interrupt, the buffer is read by the next timerPWMPrepareDMA()
+    DMA_Init(tch->dma->ref, &DMA_InitStructure);
+}
+
+static void impl_timerDMAConfigureOutput(TCH_t * tch)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(tch->dma->ref);
+    DMA_StructInit(&DMA_InitStructure);
+
+    DMA_InitStructure.DMA_Channel = dmaGetChannelByTag(tch->timHw->dmaTag);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)impl_timerCCR(tch);
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)tch->dmaBuffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+
+    DMA_Init(tch->dma->ref, &DMA_InitStructure);
+    DMA_ITConfig(tch->dma->ref, DMA_IT_TC, ENABLE);
+}
+
+static void impl_timerSwitchToInput(TCH_t * tch)
+{
+    TIM_TypeDef * tim = tch->timHw->tim;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+
+    // Edge timestamps need the full counter range. All motor channels of
+    // a timer finish their output together, the first one switches it.
+    if (tch->timCtx->dmaOutputPeriod == 0) {
+        tch->timCtx->dmaOutputPeriod = tim->ARR;
+        TIM_SetAutoreload(tim, 0xFFFF);
+        TIM_GenerateEvent(tim, TIM_EventSource_Update);
+    }
+
+    TIM_ICStructInit(&TIM_ICInitStructure);
+    TIM_ICInitStructure.TIM_Channel = lookupTIMChannelTable[tch->timHw->channelIndex];
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = 2;
+    TIM_ICInit(tim, &TIM_ICInitStructure);
+
+    impl_timerDMAConfigureInput(tch);
+    DMA_Cmd(tch->dma->ref, ENABLE);
+    TIM_DMACmd(tim, lookupDMASourceTable[tch->timHw->channelIndex], ENABLE);
+    tch->dmaInputActive = true;
+}
+
+static void impl_timerSwitchToOutput(TCH_t * tch)
+{
+    TIM_TypeDef * tim = tch->timHw->tim;
+
+    TIM_DMACmd(tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
+    DMA_Cmd(tch->dma->ref, DISABLE);
+
+    if (tch->timCtx->dmaOutputPeriod) {
+        TIM_SetAutoreload(tim, tch->timCtx->dmaOutputPeriod);
+        TIM_GenerateEvent(tim, TIM_EventSource_Update);
+        tch->timCtx->dmaOutputPeriod = 0;
+    }
+
+    impl_timerPWMConfigChannel(tch, 0);
+    impl_timerDMAConfigureOutput(tch);
+    tch->dmaInputActive = false;
+}
+
+bool impl_timerPWMConfigDMAInput(TCH_t * tch, void * dmaInputBuffer, uint32_t dmaInputBufferElementCount)
+{
+    // Complementary outputs can't capture, DMA must be set up for output already
+    if ((tch->timHw->output & TIMER_OUTPUT_N_CHANNEL) || tch->dma == NULL || tch->dmaBuffer == NULL) {
+        return false;
+    }
+
+    tch->dmaInputBuffer = dmaInputBuffer;
+    tch->dmaInputBufferElementCount = dmaInputBufferElementCount;
+    tch->dmaInputActive = false;
+
+    // Reconfigure for the inverted output
+    impl_timerPWMConfigChannel(tch, 0);
+    return true;
+}
+
+uint32_t impl_timerPWMGetDMAInputCount(TCH_t * tch)
+{
+    if (!tch->dmaInputActive) {
+        return 0;
+    }
+    return tch->dmaInputBufferElementCount - DMA_GetCurrDataCounter(tch->dma->ref);
+}
+#endif
+
 static void impl_timerDMA_IRQHandler(DMA_t descriptor)
 {
     if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
@@ -282,6 +404,12 @@ static void impl_timerDMA_IRQHandler(DMA_t descriptor)
         TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
 
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+#ifdef USE_DSHOT_BIDIR
+        if (tch->dmaInputBuffer) {
+            impl_timerSwitchToInput(tch);
+        }
+#endif
     }
 }
 
@@ -294,6 +422,7 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
     if (tch->dma == NULL) {
         return false;
     }
+    tch->dmaBuffer = dmaBuffer;
 
     // If DMA is already in use - abort
     if (tch->dma->owner != OWNER_FREE) {
@@ -372,6 +501,11 @@ void impl_timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount)
         DMA_Cmd(tch->dma->ref, DISABLE);
         TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
         DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
+#ifdef USE_DSHOT_BIDIR
+        if (tch->dmaInputActive) {
+            impl_timerSwitchToOutput(tch);
+        }
+#endif
     }
 
     DMA_SetCurrDataCounter(tch->dma->ref, dmaBufferElementCount);
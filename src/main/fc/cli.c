@@ -91,6 +91,8 @@ extern uint8_t __config_end;
 #include "io/osd.h"
 #include "io/serial.h"
 
+#include "msp/msp_stats.h"
+
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h"
 
@@ -199,9 +201,7 @@ static const char * const *sensorHardwareNames[] = {
 
 static void cliPrint(const char *str)
 {
-    while (*str) {
-        bufWriterAppend(cliWriter, *str++);
-    }
+    bufWriterAppendData(cliWriter, str, strlen(str));
 }
 
 static void cliPrintLinefeed(void)
@@ -374,7 +374,7 @@ static void printValuePointer(const setting_t *var, const void *valuePointer, ui
         break;
 
     case VAR_FLOAT:
-        cliPrintf("%s", ftoa(*(float *)valuePointer, buf));
+        cliPrint(ftoa(*(float *)valuePointer, buf));
         if (full) {
             if (SETTING_MODE(var) == MODE_DIRECT) {
                 cliPrintf(" %s", ftoa((float)settingGetMin(var), buf));
@@ -384,16 +384,18 @@ static void printValuePointer(const setting_t *var, const void *valuePointer, ui
         return; // return from case for float only
 
     case VAR_STRING:
-        cliPrintf("%s", (const char *)valuePointer);
+        cliPrint((const char *)valuePointer);
         return;
     }
 
     switch (SETTING_MODE(var)) {
     case MODE_DIRECT:
+        // Integers are the bulk of a dump, format them without going through printf
         if (SETTING_TYPE(var) == VAR_UINT32)
-            cliPrintf("%u", value);
+            ui2a(value, 10, 0, buf);
         else
-            cliPrintf("%d", value);
+            i2a(value, buf);
+        cliPrint(buf);
         if (full) {
             if (SETTING_MODE(var) == MODE_DIRECT) {
                 cliPrintf(" %d %u", settingGetMin(var), settingGetMax(var));
@@ -404,7 +406,7 @@ static void printValuePointer(const setting_t *var, const void *valuePointer, ui
     {
         const char *name = settingLookupValueName(var, value);
         if (name) {
-            cliPrintf(name);
+            cliPrint(name);
         } else {
             settingGetName(var, buf);
             cliPrintErrorLinef("VALUE %d OUT OF RANGE FOR %s", (int)value, buf);
@@ -452,8 +454,6 @@ static bool valuePtrEqualsDefault(const setting_t *value, const void *ptr, const
 static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
 {
     char name[SETTING_MAX_NAME_LENGTH];
-    const char *format = "set %s = ";
-    const char *defaultFormat = "#set %s = ";
     // During a dump, the PGs have been backed up to their "copy"
     // regions and the actual values have been reset to its
     // defaults. This means that settingGetValuePointer() will
@@ -465,11 +465,15 @@ static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
     if (((dumpMask & DO_DIFF) == 0) || !equalsDefault) {
         settingGetName(value, name);
         if (dumpMask & SHOW_DEFAULTS && !equalsDefault) {
-            cliPrintf(defaultFormat, name);
+            cliPrint("#set ");
+            cliPrint(name);
+            cliPrint(" = ");
             printValuePointer(value, defaultValuePointer, 0);
             cliPrintLinefeed();
         }
-        cliPrintf(format, name);
+        cliPrint("set ");
+        cliPrint(name);
+        cliPrint(" = ");
         printValuePointer(value, valuePointer, 0);
         cliPrintLinefeed();
     }
@@ -2954,6 +2958,7 @@ static void cliStatus(char *cmdline)
     const int rxRate = getTaskDeltaTime(TASK_RX) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_RX)));
     const int systemRate = getTaskDeltaTime(TASK_SYSTEM) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_SYSTEM)));
     cliPrintLinef(", cycle time: %d, PID rate: %d, RX rate: %d, System rate: %d",  (uint16_t)cycleTime, pidRate, rxRate, systemRate);
+    cliPrintLinef("PID looptime: %d us, gyro looptime: %d us", (int)getLooptime(), (int)getGyroLooptime());
 #if !defined(CLI_MINIMAL_VERBOSITY)
     cliPrint("Arming disabled flags:");
     uint32_t flags = armingFlags & ARMING_DISABLED_ALL_FLAGS;
@@ -3008,6 +3013,30 @@ static void cliTasks(char *cmdline)
     getCheckFuncInfo(&checkFuncInfo);
     cliPrintLinef("Task check function %13d %7d %25d", (uint32_t)checkFuncInfo.maxExecutionTime, (uint32_t)checkFuncInfo.averageExecutionTime, (uint32_t)checkFuncInfo.totalExecutionTime / 1000);
     cliPrintLinef("Total (excluding SERIAL) %21d.%1d%% %4d.%1d%%", maxLoadSum/10, maxLoadSum%10, averageLoadSum/10, averageLoadSum%10);
+    cliPrintLinef("Gyro to motor latency: %d us", (int)getGyroToMotorLatency());
+}
+#endif
+
+#ifdef USE_MSP_STATISTICS
+static void cliMspStats(char *cmdline)
+{
+    if (sl_strcasecmp(cmdline, "reset") == 0) {
+        mspStatsReset();
+        return;
+    }
+
+    cliPrintLinef("MSP command       calls  max/us  avg/us     total/ms");
+    for (int i = 0; i < mspStatsCommandCount(); i++) {
+        const mspCommandStats_t *stats = mspStatsGetCommand(i);
+        const uint32_t averageExecutionTime = stats->totalExecutionTime / stats->callCount;
+        cliPrintLinef("%5d (0x%04x)  %8d   %5d   %5d  %11d",
+                stats->cmd, stats->cmd, stats->callCount, (uint32_t)stats->maxExecutionTime, averageExecutionTime, (uint32_t)stats->totalExecutionTime / 1000);
+    }
+
+    const uint32_t untrackedCount = mspStatsUntrackedCount();
+    if (untrackedCount) {
+        cliPrintLinef("Untracked calls %10d", untrackedCount);
+    }
 }
 #endif
 
@@ -3358,6 +3387,9 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("memory", "view memory usage", NULL, cliMemory),
     CLI_COMMAND_DEF("mmix", "custom motor mixer", NULL, cliMotorMix),
     CLI_COMMAND_DEF("motor",  "get/set motor", "<index> [<value>]", cliMotor),
+#ifdef USE_MSP_STATISTICS
+    CLI_COMMAND_DEF("msp_stats", "show MSP command stats", "[reset]", cliMspStats),
+#endif
 #ifdef PLAY_SOUND
     CLI_COMMAND_DEF("play_sound", NULL, "[<index>]\r\n", cliPlaySound),
 #endif
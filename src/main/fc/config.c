@@ -162,8 +162,12 @@ __attribute__((weak)) void targetConfiguration(void)
 #endif
 
 uint32_t getLooptime(void) {
+    return gyro.targetLooptime * gyro.pidProcessDenom;
+}
+
+uint32_t getGyroLooptime(void) {
     return gyro.targetLooptime;
-} 
+}
 
 void validateAndFixConfig(void)
 {
@@ -136,3 +136,4 @@ void resetConfigs(void);
 void targetConfiguration(void);
 
 uint32_t getLooptime(void);
+uint32_t getGyroLooptime(void);
@@ -125,6 +125,12 @@ uint8_t motorControlEnable = false;
 
 static bool isRXDataNew;
 static uint32_t gyroSyncFailureCount;
+static timeUs_t gyroSampleTimeUs;           // Time of the gyro sample used by the current PID loop iteration
+static timeUs_t motorSampleTimeUs;          // Time of the gyro sample the pending motor values were mixed from
+#if defined(USE_DSHOT) || defined(USE_SERIALSHOT)
+static bool motorValuesPending;             // Motor values written since the last digital frame went out
+#endif
+static timeDelta_t gyroToMotorLatency;
 static disarmReason_t lastDisarmReason = DISARM_NONE;
 static emergencyArmingState_t emergencyArming;
 
@@ -702,38 +708,42 @@ void processRx(timeUs_t currentTimeUs)
 
 }
 
-// Function for loop trigger
-void FAST_CODE NOINLINE taskGyro(timeUs_t currentTimeUs) {
-    // getTaskDeltaTime() returns delta time frozen at the moment of entering the scheduler. currentTime is frozen at the very same point.
-    // To make busy-waiting timeout work we need to account for time spent within busy-waiting loop
-    const timeDelta_t currentDeltaTime = getTaskDeltaTime(TASK_SELF);
-    timeUs_t gyroUpdateUs = currentTimeUs;
-
+// Loop trigger. With gyro sync the loop runs when the data ready interrupt
+// signals a new sample instead of busy-waiting for it, the watchdog keeps
+// it running if the interrupt doesn't come.
+bool FAST_CODE NOINLINE taskMainPidLoopCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
+{
     if (gyroConfig()->gyroSync) {
-        while (true) {
-            gyroUpdateUs = micros();
-            if (gyroSyncCheckUpdate()) {
-                gyroSyncFailureCount = 0;
-                break;
-            }
-            else if ((currentDeltaTime + cmpTimeUs(gyroUpdateUs, currentTimeUs)) >= (timeDelta_t)(getLooptime() + GYRO_WATCHDOG_DELAY)) {
-                gyroSyncFailureCount++;
-                break;
-            }
+        if (gyroSyncCheckUpdate(&gyroSampleTimeUs)) {
+            gyroSyncFailureCount = 0;
+            return true;
+        }
+
+        if (currentDeltaTime < (timeDelta_t)(getGyroLooptime() + GYRO_WATCHDOG_DELAY)) {
+            return false;
         }
 
         // If we detect gyro sync failure - disable gyro sync
-        if (gyroSyncFailureCount > GYRO_SYNC_MAX_CONSECUTIVE_FAILURES) {
+        if (++gyroSyncFailureCount > GYRO_SYNC_MAX_CONSECUTIVE_FAILURES) {
             gyroConfigMutable()->gyroSync = false;
         }
+    } else if (currentDeltaTime < (timeDelta_t)getGyroLooptime()) {
+        return false;
     }
 
+    gyroSampleTimeUs = currentTimeUs;
+    return true;
+}
+
+void FAST_CODE NOINLINE taskGyro(timeUs_t currentTimeUs) {
+    UNUSED(currentTimeUs);
+
     /* Update actual hardware readings */
     gyroUpdate();
 
 #ifdef USE_OPFLOW
     if (sensors(SENSOR_OPFLOW)) {
-        opflowGyroUpdateCallback((timeUs_t)currentDeltaTime + (gyroUpdateUs - currentTimeUs));
+        opflowGyroUpdateCallback((timeUs_t)getTaskDeltaTime(TASK_SELF));
     }
 #endif
 }
@@ -748,9 +758,36 @@ static float calculateThrottleTiltCompensationFactor(uint8_t throttleTiltCompens
     }
 }
 
+#if defined(USE_DSHOT) || defined(USE_SERIALSHOT)
+// Frames held back by the motor update rate limit go out from the realtime
+// callback, so the latency is taken from when the frame actually started
+static void completeDigitalMotorUpdate(void)
+{
+    // Rate limited resends of the same values would report the age of a stale sample
+    if (pwmCompleteMotorUpdate() && motorValuesPending) {
+        gyroToMotorLatency = cmpTimeUs(pwmGetMotorFrameStartTime(), motorSampleTimeUs);
+        motorValuesPending = false;
+    }
+}
+#endif
+
 void taskMainPidLoop(timeUs_t currentTimeUs)
 {
-    cycleTime = getTaskDeltaTime(TASK_SELF);
+    static uint8_t pidProcessCounter;
+    static timeDelta_t pidDeltaTime;
+
+    // Gyro is sampled and filtered on every run, the rest of the loop
+    // uses the newest filtered sample every pidProcessDenom runs
+    taskGyro(currentTimeUs);
+
+    pidDeltaTime += getTaskDeltaTime(TASK_SELF);
+    if (++pidProcessCounter < gyro.pidProcessDenom) {
+        return;
+    }
+    pidProcessCounter = 0;
+
+    cycleTime = pidDeltaTime;
+    pidDeltaTime = 0;
     dT = (float)cycleTime * 0.000001f;
 
     if (ARMING_FLAG(ARMED) && (!STATE(FIXED_WING) || !isNavLaunchEnabled() || (isNavLaunchEnabled() && (isFixedWingLaunchDetected() || isFixedWingLaunchFinishedOrAborted())))) {
@@ -758,7 +795,6 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
         updateAccExtremes();
     }
 
-    taskGyro(currentTimeUs);
     imuUpdateAccelerometer();
     imuUpdateAttitude(currentTimeUs);
 
@@ -777,7 +813,7 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     isRXDataNew = false;
 
 #if defined(USE_NAV)
-    updatePositionEstimator();
+    // Position estimate is updated by TASK_POS_ESTIMATOR, only apply the nav controllers output here
     applyWaypointNavigationAndAltitudeHold();
 #endif
 
@@ -830,15 +866,36 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
 
     if (motorControlEnable) {
         writeMotors();
+        motorSampleTimeUs = gyroSampleTimeUs;
+
+#if defined(USE_DSHOT) || defined(USE_SERIALSHOT)
+        // Send digital protocol frames right after the mixer instead of
+        // waiting for the next realtime callback
+        if (isMotorProtocolDigital()) {
+            motorValuesPending = true;
+            completeDigitalMotorUpdate();
+        } else {
+            gyroToMotorLatency = cmpTimeUs(micros(), motorSampleTimeUs);
+        }
+#else
+        gyroToMotorLatency = cmpTimeUs(micros(), motorSampleTimeUs);
+#endif
     }
 
 #ifdef USE_BLACKBOX
+    // Logged after the motor update so it doesn't delay the motor output. Every
+    // PID iteration must be logged exactly once, so it can't be a separate task
     if (!cliMode && feature(FEATURE_BLACKBOX)) {
         blackboxUpdate(micros());
     }
 #endif
 }
 
+timeDelta_t getGyroToMotorLatency(void)
+{
+    return gyroToMotorLatency;
+}
+
 // This function is called in a busy-loop, everything called from here should do it's own
 // scheduling and avoid doing heavy calculations
 void taskRunRealtimeCallbacks(timeUs_t currentTimeUs)
@@ -850,7 +907,7 @@ void taskRunRealtimeCallbacks(timeUs_t currentTimeUs)
 #endif
 
 #ifdef USE_DSHOT
-    pwmCompleteMotorUpdate();
+    completeDigitalMotorUpdate();
 #endif
 }
 
@@ -44,5 +44,6 @@ void emergencyArmingUpdate(bool armingSwitchIsOn);
 
 bool isCalibrating(void);
 float getFlightTime(void);
+timeDelta_t getGyroToMotorLatency(void);
 
 void fcReboot(bool bootLoader);
@@ -89,6 +89,7 @@
 #include "msp/msp.h"
 #include "msp/msp_protocol.h"
 #include "msp/msp_serial.h"
+#include "msp/msp_stats.h"
 
 #include "navigation/navigation.h"
 
@@ -3195,6 +3196,9 @@ static mspResult_e mspProcessSensorCommand(uint16_t cmdMSP, sbuf_t *src)
  */
 mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn)
 {
+#ifdef USE_MSP_STATISTICS
+    const timeUs_t startTime = micros();
+#endif
     mspResult_e ret = MSP_RESULT_ACK;
     sbuf_t *dst = &reply->buf;
     sbuf_t *src = &cmd->buf;
@@ -3223,9 +3227,35 @@ mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostPro
     }
 
     reply->result = ret;
+
+#ifdef USE_MSP_STATISTICS
+    mspStatsRecord(cmdMSP, micros() - startTime);
+#endif
+
     return ret;
 }
 
+/*
+ * Processes a message pushed to a telemetry subscriber. Only out messages
+ * without arguments can be subscribed to, they never get a post-process function.
+ */
+mspResult_e mspFcProcessPushCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn)
+{
+    UNUSED(mspPostProcessFn);
+#ifdef USE_MSP_STATISTICS
+    const timeUs_t startTime = micros();
+#endif
+
+    reply->cmd = cmd->cmd;
+    reply->result = mspFcProcessOutCommand(cmd->cmd, &reply->buf, NULL) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
+
+#ifdef USE_MSP_STATISTICS
+    mspStatsRecord(cmd->cmd, micros() - startTime);
+#endif
+
+    return reply->result;
+}
+
 /*
  * Return a pointer to the process command function
  */
@@ -34,6 +34,7 @@
 #include "drivers/sensor.h"
 #include "drivers/serial.h"
 #include "drivers/stack_check.h"
+#include "drivers/time.h"
 
 #include "fc/cli.h"
 #include "fc/config.h"
@@ -86,6 +87,15 @@
 
 #include "uav_interconnect/uav_interconnect.h"
 
+#ifdef USE_NAV
+void taskUpdatePositionEstimator(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    updatePositionEstimator();
+}
+#endif
+
 void taskHandleSerial(timeUs_t currentTimeUs)
 {
     UNUSED(currentTimeUs);
@@ -96,6 +106,9 @@ void taskHandleSerial(timeUs_t currentTimeUs)
 
     // Allow MSP processing even if in CLI mode
     mspSerialProcess(ARMING_FLAG(ARMED) ? MSP_SKIP_NON_MSP_DATA : MSP_EVALUATE_NON_MSP_DATA, mspFcProcessCommand);
+
+    // Push telemetry to subscribed hosts after replies, so requests are served first
+    mspSerialProcessSubscriptions(millis(), mspFcProcessPushCommand);
 }
 
 void taskUpdateBattery(timeUs_t currentTimeUs)
@@ -266,9 +279,13 @@ void fcTasksInit(void)
 {
     schedulerInit();
 
-    rescheduleTask(TASK_GYROPID, getLooptime());
+    rescheduleTask(TASK_GYROPID, getGyroLooptime());
     setTaskEnabled(TASK_GYROPID, true);
 
+#ifdef USE_NAV
+    setTaskEnabled(TASK_POS_ESTIMATOR, true);
+#endif
+
     setTaskEnabled(TASK_SERIAL, true);
 #ifdef BEEPER
     setTaskEnabled(TASK_BEEPER, true);
@@ -352,9 +369,19 @@ cfTask_t cfTasks[TASK_COUNT] = {
     [TASK_GYROPID] = {
         .taskName = "GYRO/PID",
         .taskFunc = taskMainPidLoop,
+        .checkFunc = taskMainPidLoopCheck,
         .desiredPeriod = TASK_PERIOD_US(1000),
         .staticPriority = TASK_PRIORITY_REALTIME,
     },
+#ifdef USE_NAV
+    [TASK_POS_ESTIMATOR] = {
+        .taskName = "POS_ESTIMATOR",
+        .taskFunc = taskUpdatePositionEstimator,
+        .desiredPeriod = TASK_PERIOD_HZ(250),
+        .staticPriority = TASK_PRIORITY_HIGH,
+    },
+#endif
+
     [TASK_SERIAL] = {
         .taskName = "SERIAL",
         .taskFunc = taskHandleSerial,
@@ -22,6 +22,7 @@
 #include "common/time.h"
 
 void taskMainPidLoopChecker(timeUs_t currentTimeUs);
+bool taskMainPidLoopCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime);
 bool taskUpdateRxCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime);
 void taskUpdateRxMain(timeUs_t currentTimeUs);
 
@@ -54,9 +54,21 @@ static bool settingGetWord(char *buf, int idx)
 	return true;
 }
 
+// Words of the last decoded name. Consecutive settings in table order
+// usually share their leading words (e.g. nav_fw_*), so those are copied
+// from here instead of being decoded from the packed word list again.
+static struct {
+	uint16_t words[SETTING_ENCODED_NAME_MAX_BYTES];
+	uint8_t wordEnds[SETTING_ENCODED_NAME_MAX_BYTES];
+	uint8_t wordCount;
+	char name[SETTING_MAX_NAME_LENGTH];
+} settingNameCache;
+
 void settingGetName(const setting_t *val, char *buf)
 {
 	uint8_t bpos = 0;
+	uint8_t wordCount = 0;
+	bool prefixMatches = true;
 	uint16_t n = 0;
 	char word[SETTING_MAX_WORD_LENGTH];
 #ifndef SETTING_ENCODED_NAME_USES_BYTE_INDEXING
@@ -77,23 +89,37 @@ void settingGetName(const setting_t *val, char *buf)
 		// Final byte
 		n |= b << shift;
 #endif
-		if (!settingGetWord(word, n)) {
+		if (n == 0) {
 			// No more words
 			break;
 		}
-		if (bpos > 0) {
-			// Word separator
-			buf[bpos++] = '_';
+		prefixMatches = prefixMatches && wordCount < settingNameCache.wordCount && settingNameCache.words[wordCount] == n;
+		if (prefixMatches) {
+			// Same word as in the previously decoded name, already in the cache
+			bpos = settingNameCache.wordEnds[wordCount];
+		} else {
+			if (!settingGetWord(word, n)) {
+				break;
+			}
+			if (bpos > 0) {
+				// Word separator
+				settingNameCache.name[bpos++] = '_';
+			}
+			strcpy(&settingNameCache.name[bpos], word);
+			bpos += strlen(word);
 		}
-		strcpy(&buf[bpos], word);
-		bpos += strlen(word);
+		settingNameCache.words[wordCount] = n;
+		settingNameCache.wordEnds[wordCount] = bpos;
+		wordCount++;
 #ifndef SETTING_ENCODED_NAME_USES_BYTE_INDEXING
 		// Reset shift and n
 		shift = 0;
 		n = 0;
 #endif
 	}
-	buf[bpos] = '\0';
+	settingNameCache.name[bpos] = '\0';
+	settingNameCache.wordCount = wordCount;
+	memcpy(buf, settingNameCache.name, bpos + 1);
 }
 
 bool settingNameContains(const setting_t *val, char *buf, const char *cmdline)
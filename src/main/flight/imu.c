@@ -46,6 +46,7 @@
 
 #include "flight/hil.h"
 #include "flight/imu.h"
+#include "flight/imu_ekf.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
 
@@ -87,14 +88,24 @@ STATIC_FASTRAM fpVector3_t vCorrectedMagNorth;             // Magnetic North vec
 
 FASTRAM fpQuaternion_t orientation;
 FASTRAM attitudeEulerAngles_t attitude;             // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
-FASTRAM float rMat[3][3];
+STATIC_FASTRAM fpMat3_t rMat;                      // Computed from orientation on demand, see imuGetRotationMatrix()
+STATIC_FASTRAM bool rMatValid;
 
 STATIC_FASTRAM imuRuntimeConfig_t imuRuntimeConfig;
 STATIC_FASTRAM pt1Filter_t rotRateFilter;
 
 STATIC_FASTRAM bool gpsHeadingInitialized;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(imuConfig_t, imuConfig, PG_IMU_CONFIG, 2);
+STATIC_FASTRAM fpVector3_t vGyroDriftEstimate;
+STATIC_FASTRAM fpVector3_t vCorrectionRate;             // Feedback from the last correction step, rad/s
+STATIC_FASTRAM fpVector3_t vPrevGyroDelta;              // Previous gyro rotation vector for coning compensation
+STATIC_FASTRAM float correctionDt;                       // Time accumulated since the last correction step
+
+#if defined(USE_IMU_EKF)
+STATIC_FASTRAM bool ekfActive;
+#endif
+
+PG_REGISTER_WITH_RESET_TEMPLATE(imuConfig_t, imuConfig, PG_IMU_CONFIG, 4);
 
 PG_RESET_TEMPLATE(imuConfig_t, imuConfig,
     .dcm_kp_acc = 2500,             // 0.25 * 10000
@@ -103,7 +114,9 @@ PG_RESET_TEMPLATE(imuConfig_t, imuConfig,
     .dcm_ki_mag = 0,                // 0.00 * 10000
     .small_angle = 25,
     .acc_ignore_rate = 0,
-    .acc_ignore_slope = 0
+    .acc_ignore_slope = 0,
+    .correction_hz = 100,
+    .ahrs_type = AHRS_TYPE_MAHONY
 );
 
 STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
@@ -119,17 +132,28 @@ STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
     float q1q3 = orientation.q1 * orientation.q3;
     float q2q3 = orientation.q2 * orientation.q3;
 
-    rMat[0][0] = 1.0f - 2.0f * q2q2 - 2.0f * q3q3;
-    rMat[0][1] = 2.0f * (q1q2 + -q0q3);
-    rMat[0][2] = 2.0f * (q1q3 - -q0q2);
+    rMat.m[0][0] = 1.0f - 2.0f * q2q2 - 2.0f * q3q3;
+    rMat.m[0][1] = 2.0f * (q1q2 + -q0q3);
+    rMat.m[0][2] = 2.0f * (q1q3 - -q0q2);
+
+    rMat.m[1][0] = 2.0f * (q1q2 - -q0q3);
+    rMat.m[1][1] = 1.0f - 2.0f * q1q1 - 2.0f * q3q3;
+    rMat.m[1][2] = 2.0f * (q2q3 + -q0q1);
+
+    rMat.m[2][0] = 2.0f * (q1q3 + -q0q2);
+    rMat.m[2][1] = 2.0f * (q2q3 - -q0q1);
+    rMat.m[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
 
-    rMat[1][0] = 2.0f * (q1q2 - -q0q3);
-    rMat[1][1] = 1.0f - 2.0f * q1q1 - 2.0f * q3q3;
-    rMat[1][2] = 2.0f * (q2q3 + -q0q1);
+    rMatValid = true;
+}
+
+const fpMat3_t * imuGetRotationMatrix(void)
+{
+    if (!rMatValid) {
+        imuComputeRotationMatrix();
+    }
 
-    rMat[2][0] = 2.0f * (q1q3 + -q0q2);
-    rMat[2][1] = 2.0f * (q2q3 - -q0q1);
-    rMat[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
+    return &rMat;
 }
 
 void imuConfigure(void)
@@ -139,6 +163,7 @@ void imuConfigure(void)
     imuRuntimeConfig.dcm_kp_mag = imuConfig()->dcm_kp_mag / 10000.0f;
     imuRuntimeConfig.dcm_ki_mag = imuConfig()->dcm_ki_mag / 10000.0f;
     imuRuntimeConfig.small_angle = imuConfig()->small_angle;
+    imuRuntimeConfig.correction_period = imuConfig()->correction_hz ? 1.0f / imuConfig()->correction_hz : 0.0f;
 }
 
 void imuInit(void)
@@ -152,6 +177,13 @@ void imuInit(void)
     // Explicitly initialize FASTRAM statics
     isAccelUpdatedAtLeastOnce = false;
     gpsHeadingInitialized = false;
+    vectorZero(&vGyroDriftEstimate);
+    vectorZero(&vCorrectionRate);
+    vectorZero(&vPrevGyroDelta);
+    correctionDt = 0;
+#if defined(USE_IMU_EKF)
+    ekfActive = false;
+#endif
 
     // Create magnetic declination matrix
     const int deg = compassConfig()->mag_declination / 100;
@@ -159,7 +191,7 @@ void imuInit(void)
     imuSetMagneticDeclination(deg + min / 60.0f);
 
     quaternionInitUnit(&orientation);
-    imuComputeRotationMatrix();
+    rMatValid = false;
 
     // Initialize rotation rate filter
     pt1FilterReset(&rotRateFilter, 0);
@@ -212,7 +244,7 @@ STATIC_UNIT_TESTED void imuComputeQuaternionFromRPY(int16_t initialRoll, int16_t
     orientation.q2 = cosRoll * sinPitch * cosYaw + sinRoll * cosPitch * sinYaw;
     orientation.q3 = cosRoll * cosPitch * sinYaw - sinRoll * sinPitch * cosYaw;
 
-    imuComputeRotationMatrix();
+    rMatValid = false;
 }
 #endif
 
@@ -289,79 +321,89 @@ static void imuCheckAndResetOrientationQuaternion(const fpQuaternion_t * quat, c
 #endif
 }
 
-static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF, const fpVector3_t * magBF, bool useCOG, float courseOverGround, float accWScaler, float magWScaler)
+/*
+ * Heading error between the estimated orientation and the measured magnetic
+ * field or course over ground. Mag and course vectors are projected to the
+ * horizontal plane, so the error is a rotation around EF Z axis only.
+ */
+static float imuCalculateHeadingError(const fpQuaternion_t * quat, const fpVector3_t * magBF, bool useCOG, float courseOverGround)
 {
-    STATIC_FASTRAM fpVector3_t vGyroDriftEstimate = { 0 };
+    static const fpVector3_t vForward = { .v = { 1.0f, 0.0f, 0.0f } };
 
-    fpQuaternion_t prevOrientation = orientation;
-    fpVector3_t vRotation = *gyroBF;
+    fpVector3_t vErr = { .v = { 0.0f, 0.0f, 0.0f } };
 
-    /* Calculate general spin rate (rad/s) */
-    const float spin_rate_sq = vectorNormSquared(&vRotation);
-
-    /* Step 1: Yaw correction */
-    // Use measured magnetic field vector
-    if (magBF || useCOG) {
-        static const fpVector3_t vForward = { .v = { 1.0f, 0.0f, 0.0f } };
+    if (magBF && vectorNormSquared(magBF) > 0.01f) {
+        fpVector3_t vMag;
 
-        fpVector3_t vErr = { .v = { 0.0f, 0.0f, 0.0f } };
+        // For magnetometer correction we make an assumption that magnetic field is perpendicular to gravity (ignore Z-component in EF).
+        // This way magnetic field will only affect heading and wont mess roll/pitch angles
 
-        if (magBF && vectorNormSquared(magBF) > 0.01f) {
-            fpVector3_t vMag;
+        // (hx; hy; 0) - measured mag field vector in EF (assuming Z-component is zero)
+        // This should yield direction to magnetic North (1; 0; 0)
+        quaternionRotateVectorInv(&vMag, magBF, quat);    // BF -> EF
 
-            // For magnetometer correction we make an assumption that magnetic field is perpendicular to gravity (ignore Z-component in EF).
-            // This way magnetic field will only affect heading and wont mess roll/pitch angles
+        // Ignore magnetic inclination
+        vMag.z = 0.0f;
 
-            // (hx; hy; 0) - measured mag field vector in EF (assuming Z-component is zero)
-            // This should yield direction to magnetic North (1; 0; 0)
-            quaternionRotateVectorInv(&vMag, magBF, &orientation);    // BF -> EF
+        // We zeroed out vMag.z -  make sure the whole vector didn't go to zero
+        if (vectorNormSquared(&vMag) > 0.01f) {
+            // Normalize to unit vector
+            vectorNormalize(&vMag, &vMag);
 
-            // Ignore magnetic inclination
-            vMag.z = 0.0f;
+            // Reference mag field vector heading is Magnetic North in EF. We compute that by rotating True North vector by declination and assuming Z-component is zero
+            // magnetometer error is cross product between estimated magnetic north and measured magnetic north (calculated in EF)
+            vectorCrossProduct(&vErr, &vMag, &vCorrectedMagNorth);
+        }
+    }
+    else if (useCOG) {
+        fpVector3_t vHeadingEF;
 
-            // We zeroed out vMag.z -  make sure the whole vector didn't go to zero
-            if (vectorNormSquared(&vMag) > 0.01f) {
-                // Normalize to unit vector
-                vectorNormalize(&vMag, &vMag);
+        // Use raw heading error (from GPS or whatever else)
+        while (courseOverGround >  M_PIf) courseOverGround -= (2.0f * M_PIf);
+        while (courseOverGround < -M_PIf) courseOverGround += (2.0f * M_PIf);
 
-                // Reference mag field vector heading is Magnetic North in EF. We compute that by rotating True North vector by declination and assuming Z-component is zero
-                // magnetometer error is cross product between estimated magnetic north and measured magnetic north (calculated in EF)
-                vectorCrossProduct(&vErr, &vMag, &vCorrectedMagNorth);
+        // William Premerlani and Paul Bizard, Direction Cosine Matrix IMU - Eqn. 22-23
+        // (Rxx; Ryx) - measured (estimated) heading vector (EF)
+        // (-cos(COG), sin(COG)) - reference heading vector (EF)
 
-                // Rotate error back into body frame
-                quaternionRotateVector(&vErr, &vErr, &orientation);
-            }
-        }
-        else if (useCOG) {
-            fpVector3_t vHeadingEF;
+        // Compute heading vector in EF from scalar CoG
+        fpVector3_t vCoG = { .v = { -cos_approx(courseOverGround), sin_approx(courseOverGround), 0.0f } };
 
-            // Use raw heading error (from GPS or whatever else)
-            while (courseOverGround >  M_PIf) courseOverGround -= (2.0f * M_PIf);
-            while (courseOverGround < -M_PIf) courseOverGround += (2.0f * M_PIf);
+        // Rotate Forward vector from BF to EF - will yield Heading vector in Earth frame
+        quaternionRotateVectorInv(&vHeadingEF, &vForward, quat);
+        vHeadingEF.z = 0.0f;
 
-            // William Premerlani and Paul Bizard, Direction Cosine Matrix IMU - Eqn. 22-23
-            // (Rxx; Ryx) - measured (estimated) heading vector (EF)
-            // (-cos(COG), sin(COG)) - reference heading vector (EF)
+        // We zeroed out vHeadingEF.z -  make sure the whole vector didn't go to zero
+        if (vectorNormSquared(&vHeadingEF) > 0.01f) {
+            // Normalize to unit vector
+            vectorNormalize(&vHeadingEF, &vHeadingEF);
 
-            // Compute heading vector in EF from scalar CoG
-            fpVector3_t vCoG = { .v = { -cos_approx(courseOverGround), sin_approx(courseOverGround), 0.0f } };
+            // error is cross product between reference heading and estimated heading (calculated in EF)
+            vectorCrossProduct(&vErr, &vCoG, &vHeadingEF);
+        }
+    }
 
-            // Rotate Forward vector from BF to EF - will yield Heading vector in Earth frame
-            quaternionRotateVectorInv(&vHeadingEF, &vForward, &orientation);
-            vHeadingEF.z = 0.0f;
+    return vErr.z;
+}
 
-            // We zeroed out vHeadingEF.z -  make sure the whole vector didn't go to zero
-            if (vectorNormSquared(&vHeadingEF) > 0.01f) {
-                // Normalize to unit vector
-                vectorNormalize(&vHeadingEF, &vHeadingEF);
+/*
+ * Correction step, runs when new reference data is due. Computes the
+ * feedback rate from the error between the estimated and the measured
+ * acc/mag/course vectors. It is applied by every following prediction step.
+ */
+static void imuMahonyAHRSCorrection(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF, const fpVector3_t * magBF, bool useCOG, float courseOverGround, float accWScaler, float magWScaler)
+{
+    /* Calculate general spin rate (rad/s) */
+    const float spin_rate_sq = vectorNormSquared(gyroBF);
 
-                // error is cross product between reference heading and estimated heading (calculated in EF)
-                vectorCrossProduct(&vErr, &vCoG, &vHeadingEF);
+    fpVector3_t vRotation = { .v = { 0.0f, 0.0f, 0.0f } };
 
-                // Rotate error back into body frame
-                quaternionRotateVector(&vErr, &vErr, &orientation);
-            }
-        }
+    /* Step 1: Yaw correction */
+    // Use measured magnetic field vector
+    if (magBF || useCOG) {
+        // Heading error is around the EF Z axis, rotate it into body frame
+        fpVector3_t vErr = { .v = { 0.0f, 0.0f, imuCalculateHeadingError(&orientation, magBF, useCOG, courseOverGround) } };
+        quaternionRotateVector(&vErr, &vErr, &orientation);
 
         // Compute and apply integral feedback if enabled
         if (imuRuntimeConfig.dcm_ki_mag > 0.0f) {
@@ -410,14 +452,36 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
         vectorAdd(&vRotation, &vRotation, &vErr);
     }
 
-    // Apply gyro drift correction
-    vectorAdd(&vRotation, &vRotation, &vGyroDriftEstimate);
+    vCorrectionRate = vRotation;
+}
+
+/*
+ * Prediction step, runs on every IMU update. Integrates the gyro rate
+ * together with the drift estimate and the last correction feedback.
+ */
+static void imuMahonyAHRSPredict(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF)
+{
+    fpQuaternion_t prevOrientation = orientation;
+    fpVector3_t vRotation;
+
+    // Two-sample coning compensation (Savage), the body rotates during the
+    // sample interval so consecutive rotation vectors don't commute
+    fpVector3_t vGyroDelta, vConing;
+    vectorScale(&vGyroDelta, gyroBF, dt);
+    vectorCrossProduct(&vConing, &vPrevGyroDelta, &vGyroDelta);
+    vPrevGyroDelta = vGyroDelta;
+
+    // Apply gyro drift and reference feedback correction
+    vectorAdd(&vRotation, gyroBF, &vGyroDriftEstimate);
+    vectorAdd(&vRotation, &vRotation, &vCorrectionRate);
 
     // Integrate rate of change of quaternion
     fpVector3_t vTheta;
     fpQuaternion_t deltaQ;
 
     vectorScale(&vTheta, &vRotation, 0.5f * dt);
+    vectorScale(&vConing, &vConing, 0.5f / 12.0f);
+    vectorAdd(&vTheta, &vTheta, &vConing);
     quaternionInitFromVector(&deltaQ, &vTheta);
     const float thetaMagnitudeSq = vectorNormSquared(&vTheta);
 
@@ -446,16 +510,23 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
     // Check for invalid quaternion and reset to previous known good one
     imuCheckAndResetOrientationQuaternion(&prevOrientation, accBF);
 
-    // Pre-compute rotation matrix from quaternion
-    imuComputeRotationMatrix();
+    // Rotation matrix is rebuilt on first use
+    rMatValid = false;
 }
 
 STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
 {
+    // Only the five rotation matrix elements the angles depend on, straight from the quaternion
+    const float r00 = 1.0f - 2.0f * (orientation.q2 * orientation.q2 + orientation.q3 * orientation.q3);
+    const float r10 = 2.0f * (orientation.q1 * orientation.q2 + orientation.q0 * orientation.q3);
+    const float r20 = 2.0f * (orientation.q1 * orientation.q3 - orientation.q0 * orientation.q2);
+    const float r21 = 2.0f * (orientation.q2 * orientation.q3 + orientation.q0 * orientation.q1);
+    const float r22 = 1.0f - 2.0f * (orientation.q1 * orientation.q1 + orientation.q2 * orientation.q2);
+
     /* Compute pitch/roll angles */
-    attitude.values.roll = RADIANS_TO_DECIDEGREES(atan2_approx(rMat[2][1], rMat[2][2]));
-    attitude.values.pitch = RADIANS_TO_DECIDEGREES((0.5f * M_PIf) - acos_approx(-rMat[2][0]));
-    attitude.values.yaw = RADIANS_TO_DECIDEGREES(-atan2_approx(rMat[1][0], rMat[0][0]));
+    attitude.values.roll = RADIANS_TO_DECIDEGREES(atan2_approx(r21, r22));
+    attitude.values.pitch = RADIANS_TO_DECIDEGREES((0.5f * M_PIf) - acos_approx(-r20));
+    attitude.values.yaw = RADIANS_TO_DECIDEGREES(-atan2_approx(r10, r00));
 
     if (attitude.values.yaw < 0)
         attitude.values.yaw += 3600;
@@ -519,8 +590,54 @@ static float imuCalculateAccelerometerWeight(const float dT)
     return accWeight_Nearness * accWeight_RateIgnore;
 }
 
+static void imuPredictAttitude(float dT)
+{
+#if defined(USE_IMU_EKF)
+    if (ekfActive) {
+        imuEkfPredict(dT, &imuMeasuredRotationBF, &imuMeasuredAccelBF);
+
+        if (imuConfig()->ahrs_type == AHRS_TYPE_EKF) {
+            orientation = *imuEkfGetOrientation();
+            rMatValid = false;
+            return;
+        }
+    }
+#endif
+
+    imuMahonyAHRSPredict(dT, &imuMeasuredRotationBF, &imuMeasuredAccelBF);
+}
+
 static void imuCalculateEstimatedAttitude(float dT)
 {
+#if defined(USE_IMU_EKF)
+    const bool useEkf = imuConfig()->ahrs_type == AHRS_TYPE_EKF;
+
+    // EKF also runs in the background when its debug output is selected, to compare both estimates in blackbox
+    if (useEkf || debugMode == DEBUG_EKF || debugMode == DEBUG_EKF_NAV) {
+        if (!ekfActive) {
+            imuEkfReset(&orientation);
+            ekfActive = true;
+        }
+    }
+    else if (ekfActive) {
+        imuEkfStop();
+        ekfActive = false;
+    }
+#else
+    const bool useEkf = false;
+#endif
+
+    // Reference vectors change slowly, only correct at the configured rate
+    correctionDt += dT;
+    if (correctionDt < imuRuntimeConfig.correction_period) {
+        imuPredictAttitude(dT);
+        imuUpdateEulerAngles();
+        return;
+    }
+
+    const float correctionPeriod = correctionDt;
+    correctionDt = 0;
+
 #if defined(USE_MAG)
     const bool canUseMAG = sensors(SENSOR_MAG) && compassIsHealthy();
 #else
@@ -549,6 +666,11 @@ static void imuCalculateEstimatedAttitude(float dT)
                 // Re-initialize quaternion from known Roll, Pitch and GPS heading
                 imuComputeQuaternionFromRPY(attitude.values.roll, attitude.values.pitch, gpsSol.groundCourse);
                 gpsHeadingInitialized = true;
+#if defined(USE_IMU_EKF)
+                if (ekfActive) {
+                    imuEkfReset(&orientation);
+                }
+#endif
 
                 // Force reset of heading hold target
                 resetHeadingHoldTarget(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
@@ -571,15 +693,36 @@ static void imuCalculateEstimatedAttitude(float dT)
     fpVector3_t measuredMagBF = { .v = { mag.magADC[X], mag.magADC[Y], mag.magADC[Z] } };
 
     const float magWeight = imuGetPGainScaleFactor() * 1.0f;
-    const float accWeight = imuGetPGainScaleFactor() * imuCalculateAccelerometerWeight(dT);
+    const float accWeight = imuGetPGainScaleFactor() * imuCalculateAccelerometerWeight(correctionPeriod);
     const bool useAcc = (accWeight > 0.001f);
 
-    imuMahonyAHRSupdate(dT, &imuMeasuredRotationBF,
-                            useAcc ? &imuMeasuredAccelBF : NULL,
-                            useMag ? &measuredMagBF : NULL,
-                            useCOG, courseOverGround,
-                            accWeight,
-                            magWeight);
+#if defined(USE_IMU_EKF)
+    if (ekfActive) {
+        // Reject outliers (GPS course glitches, sustained acceleration) only in flight,
+        // on the ground the estimate has to converge from any initial orientation
+        const bool useGate = ARMING_FLAG(ARMED);
+
+        if (useAcc) {
+            imuEkfUpdateGravity(&imuMeasuredAccelBF, accWeight, useGate);
+        }
+
+        if (useMag || useCOG) {
+            const float headingError = imuCalculateHeadingError(imuEkfGetOrientation(), useMag ? &measuredMagBF : NULL, useCOG, courseOverGround);
+            imuEkfUpdateHeading(headingError, magWeight, useGate);
+        }
+    }
+#endif
+
+    if (!useEkf) {
+        imuMahonyAHRSCorrection(correctionPeriod, &imuMeasuredRotationBF,
+                                useAcc ? &imuMeasuredAccelBF : NULL,
+                                useMag ? &measuredMagBF : NULL,
+                                useCOG, courseOverGround,
+                                accWeight,
+                                magWeight);
+    }
+
+    imuPredictAttitude(dT);
 
     imuUpdateEulerAngles();
 }
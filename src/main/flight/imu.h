@@ -39,7 +39,11 @@ typedef union {
 
 extern fpQuaternion_t orientation;
 extern attitudeEulerAngles_t attitude;
-extern float rMat[3][3];
+
+typedef enum {
+    AHRS_TYPE_MAHONY = 0,
+    AHRS_TYPE_EKF
+} ahrsType_e;
 
 typedef struct imuConfig_s {
     uint16_t dcm_kp_acc;                    // DCM filter proportional gain ( x 10000) for accelerometer
@@ -49,6 +53,8 @@ typedef struct imuConfig_s {
     uint8_t small_angle;
     uint8_t acc_ignore_rate;
     uint8_t acc_ignore_slope;
+    uint16_t correction_hz;                 // Rate of acc/mag/GPS course corrections, 0 = every update
+    uint8_t ahrs_type;                      // Attitude estimator, see ahrsType_e
 } imuConfig_t;
 
 PG_DECLARE(imuConfig_t, imuConfig);
@@ -59,6 +65,7 @@ typedef struct imuRuntimeConfig_s {
     float dcm_kp_mag;
     float dcm_ki_mag;
     uint8_t small_angle;
+    float correction_period;
 } imuRuntimeConfig_t;
 
 void imuConfigure(void);
@@ -67,6 +74,7 @@ void imuSetMagneticDeclination(float declinationDeg);
 void imuUpdateAttitude(timeUs_t currentTimeUs);
 void imuUpdateAccelerometer(void);
 float calculateCosTiltAngle(void);
+const fpMat3_t * imuGetRotationMatrix(void);
 bool isImuReady(void);
 bool isImuHeadingValid(void);
 
@@ -0,0 +1,723 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#if defined(USE_IMU_EKF)
+
+#include "build/build_config.h"
+#include "build/debug.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/quaternion.h"
+#include "common/vector.h"
+
+#include "flight/imu_ekf.h"
+
+#include "sensors/acceleration.h"
+
+/*
+ * Error-state EKF for attitude, velocity, position, gyro bias, horizontal
+ * wind and vertical accelerometer bias.
+ *
+ * The nominal state is integrated from gyro and accelerometer on every IMU
+ * update, the filter estimates its error and folds it back after each
+ * correction. The attitude error is in body frame (same sense as gyro
+ * integration), everything else is in the earth frame of the orientation
+ * quaternion. NEU measurements are converted on the way in, the same way
+ * as imuTransformVectorBodyToEarth() does.
+ *
+ * Covariance is propagated lazily on the next measurement with a sparse
+ * transition matrix and measurements are processed one scalar at a time,
+ * so no matrix inversion is needed and the cost of a correction is fixed.
+ * Horizontal and vertical states are held at zero with a large variance
+ * while no GPS or baro measurement aids them.
+ */
+
+#define EKF_GYRO_NOISE          0.01f       // rad/s/sqrt(Hz)
+#define EKF_GYRO_BIAS_NOISE     0.0001f     // rad/s/sqrt(s)
+#define EKF_ACC_PROCESS_NOISE   50.0f       // cm/s/s/sqrt(Hz)
+#define EKF_ACC_BIAS_NOISE      1.0f        // cm/s/s/sqrt(s)
+#define EKF_WIND_NOISE          10.0f       // cm/s/sqrt(s)
+#define EKF_ACC_NOISE           0.5f        // G, includes vibration and manoeuvre acceleration
+#define EKF_HEADING_NOISE       0.2f        // rad
+#define EKF_GPS_VEL_NOISE       50.0f       // cm/s
+#define EKF_GPS_VEL_Z_NOISE     100.0f      // cm/s
+#define EKF_SIDESLIP_NOISE      200.0f      // cm/s of lateral airspeed
+#define EKF_AIRSPEED_NOISE      200.0f      // cm/s
+
+#define EKF_INITIAL_ATT_VAR     sq(0.3f)    // rad^2
+#define EKF_INITIAL_BIAS_VAR    sq(0.02f)   // (rad/s)^2
+#define EKF_INITIAL_VEL_VAR     sq(500.0f)  // (cm/s)^2
+#define EKF_INITIAL_WIND_VAR    sq(500.0f)  // (cm/s)^2
+#define EKF_INITIAL_ACC_BIAS_VAR sq(50.0f)  // (cm/s/s)^2
+#define EKF_UNAIDED_VAR         sq(100000.0f)
+
+#define EKF_AIDING_TIMEOUT      1.5f        // s without GPS or baro before the states are no longer aided
+#define EKF_MIN_AIRSPEED        500.0f      // cm/s, no air data updates below
+
+#define EKF_INNOVATION_GATE     5.0f        // Sigma
+#define EKF_MAX_REJECTIONS      300         // Consecutive rejected updates before covariance is inflated
+#define EKF_MAX_NAV_REJECTIONS  25          // Consecutive rejected GPS or baro updates before the states are reset to them
+
+#define EKF_TRANSITION_ENTRIES  22
+
+typedef struct {
+    fpQuaternion_t orientation;
+    fpVector3_t vel;
+    fpVector3_t pos;
+    fpVector3_t gyroBias;
+    float wind[2];
+    float accBiasZ;
+} ekfNominalState_t;
+
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    float value;
+} ekfTransitionEntry_t;
+
+STATIC_UNIT_TESTED float ekfP[EKF_STATE_COUNT][EKF_STATE_COUNT];
+STATIC_UNIT_TESTED float ekfX[EKF_STATE_COUNT];
+static float ekfFP[EKF_STATE_COUNT][EKF_STATE_COUNT];
+
+static ekfNominalState_t ekfState;
+static bool ekfRunning = false;
+
+static bool ekfHorizontalAided;
+static bool ekfVerticalAided;
+static float ekfHorizontalAidingAge;
+static float ekfVerticalAidingAge;
+
+// Covariance is propagated lazily, on the next measurement update
+static fpVector3_t ekfGyroDeltaSum;
+static fpVector3_t ekfVelocityDeltaSum;     // Integrated specific force in earth frame
+static float ekfCovarianceDt;
+
+static uint16_t ekfGravityRejections;
+static uint16_t ekfHeadingRejections;
+static uint16_t ekfGpsRejections;
+static uint16_t ekfBaroRejections;
+
+static void ekfInflateAttitudeCovariance(void)
+{
+    for (int i = EKF_ATT; i < EKF_ATT + 3; i++) {
+        ekfP[i][i] += EKF_INITIAL_ATT_VAR;
+    }
+}
+
+// Decouples a state from all others, its nominal value is set by the caller
+static void ekfResetState(int index, float variance)
+{
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        ekfP[index][i] = 0;
+        ekfP[i][index] = 0;
+    }
+
+    ekfP[index][index] = variance;
+    ekfX[index] = 0;
+}
+
+static void ekfResetHorizontal(const fpVector3_t * pos, const fpVector3_t * vel, float posVariance, float velVariance)
+{
+    for (int axis = 0; axis < 2; axis++) {
+        ekfState.pos.v[axis] = pos->v[axis];
+        ekfState.vel.v[axis] = vel->v[axis];
+        ekfResetState(EKF_POS + axis, posVariance);
+        ekfResetState(EKF_VEL + axis, velVariance);
+    }
+
+    ekfGpsRejections = 0;
+}
+
+static void ekfResetVertical(float pos, float vel, float posVariance, float velVariance)
+{
+    ekfState.pos.z = pos;
+    ekfState.vel.z = vel;
+    ekfResetState(EKF_POS + 2, posVariance);
+    ekfResetState(EKF_VEL + 2, velVariance);
+
+    ekfBaroRejections = 0;
+}
+
+static void ekfResetWind(float variance)
+{
+    for (int axis = 0; axis < 2; axis++) {
+        ekfState.wind[axis] = 0;
+        ekfResetState(EKF_WIND + axis, variance);
+    }
+}
+
+void imuEkfReset(const fpQuaternion_t * initialOrientation)
+{
+    static const fpVector3_t vZero = { .v = { 0.0f, 0.0f, 0.0f } };
+
+    memset(ekfP, 0, sizeof(ekfP));
+    memset(ekfX, 0, sizeof(ekfX));
+
+    for (int i = 0; i < 3; i++) {
+        ekfP[EKF_ATT + i][EKF_ATT + i] = EKF_INITIAL_ATT_VAR;
+        ekfP[EKF_GYRO_BIAS + i][EKF_GYRO_BIAS + i] = EKF_INITIAL_BIAS_VAR;
+    }
+    ekfP[EKF_ACC_BIAS_Z][EKF_ACC_BIAS_Z] = EKF_INITIAL_ACC_BIAS_VAR;
+
+    ekfState.orientation = *initialOrientation;
+    vectorZero(&ekfState.gyroBias);
+    ekfState.accBiasZ = 0;
+
+    ekfResetHorizontal(&vZero, &vZero, EKF_UNAIDED_VAR, EKF_UNAIDED_VAR);
+    ekfResetVertical(0, 0, EKF_UNAIDED_VAR, EKF_UNAIDED_VAR);
+    ekfResetWind(EKF_UNAIDED_VAR);
+    ekfHorizontalAided = false;
+    ekfVerticalAided = false;
+    ekfHorizontalAidingAge = 0;
+    ekfVerticalAidingAge = 0;
+
+    vectorZero(&ekfGyroDeltaSum);
+    vectorZero(&ekfVelocityDeltaSum);
+    ekfCovarianceDt = 0;
+    ekfGravityRejections = 0;
+    ekfHeadingRejections = 0;
+    ekfRunning = true;
+}
+
+void imuEkfStop(void)
+{
+    ekfRunning = false;
+}
+
+static void ekfRotate(fpQuaternion_t * q, const fpVector3_t * vAngle)
+{
+    const float angleSq = vectorNormSquared(vAngle);
+    if (angleSq < 1e-20f) {
+        return;
+    }
+
+    // Small rotations use the Taylor series, see imuMahonyAHRSPredict()
+    fpQuaternion_t deltaQ;
+    fpVector3_t vHalfAngle;
+    vectorScale(&vHalfAngle, vAngle, 0.5f);
+    quaternionInitFromVector(&deltaQ, &vHalfAngle);
+
+    const float halfAngleSq = angleSq * 0.25f;
+    if (halfAngleSq < sqrtf(24.0f * 1e-6f)) {
+        quaternionScale(&deltaQ, &deltaQ, 1.0f - halfAngleSq / 6.0f);
+        deltaQ.q0 = 1.0f - halfAngleSq / 2.0f;
+    }
+    else {
+        const float halfAngle = sqrtf(halfAngleSq);
+        quaternionScale(&deltaQ, &deltaQ, sin_approx(halfAngle) / halfAngle);
+        deltaQ.q0 = cos_approx(halfAngle);
+    }
+
+    quaternionMultiply(q, q, &deltaQ);
+    quaternionNormalize(q, q);
+}
+
+void imuEkfPredict(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF)
+{
+    const fpVector3_t vAngle = { .v = {
+        (gyroBF->x - ekfState.gyroBias.x) * dt,
+        (gyroBF->y - ekfState.gyroBias.y) * dt,
+        (gyroBF->z - ekfState.gyroBias.z) * dt
+    } };
+
+    ekfRotate(&ekfState.orientation, &vAngle);
+
+    // Specific force in earth frame
+    fpVector3_t vAccEF;
+    quaternionRotateVectorInv(&vAccEF, accBF, &ekfState.orientation);
+
+    for (int axis = 0; axis < 3; axis++) {
+        ekfVelocityDeltaSum.v[axis] += vAccEF.v[axis] * dt;
+    }
+
+    vAccEF.z -= GRAVITY_CMSS + ekfState.accBiasZ;
+
+    for (int axis = 0; axis < 3; axis++) {
+        if ((axis == Z) ? ekfVerticalAided : ekfHorizontalAided) {
+            ekfState.pos.v[axis] += (ekfState.vel.v[axis] + vAccEF.v[axis] * dt * 0.5f) * dt;
+            ekfState.vel.v[axis] += vAccEF.v[axis] * dt;
+        }
+    }
+
+    vectorAdd(&ekfGyroDeltaSum, &ekfGyroDeltaSum, &vAngle);
+    ekfCovarianceDt += dt;
+    ekfHorizontalAidingAge += dt;
+    ekfVerticalAidingAge += dt;
+}
+
+static void ekfAddTransition(ekfTransitionEntry_t * entries, int * count, int row, int col, float value)
+{
+    entries[*count].row = row;
+    entries[*count].col = col;
+    entries[*count].value = value;
+    (*count)++;
+}
+
+/*
+ * P = F * P * F' over the time since the last update. dAngle is the integrated
+ * rotation and dVelocity the integrated specific force in earth frame. Only
+ * the non-zero entries of F - I are stored:
+ *      attitude    -[dAngle x], -I dt to gyro bias
+ *      velocity    -[dVelocity x] * R to attitude, -dt to vertical acc bias
+ *      position    I dt to velocity
+ */
+STATIC_UNIT_TESTED void ekfPredictCovariance(const fpVector3_t * dAngle, const fpVector3_t * dVelocity, float dt)
+{
+    ekfTransitionEntry_t G[EKF_TRANSITION_ENTRIES];
+    int count = 0;
+
+    ekfAddTransition(G, &count, EKF_ATT + 0, EKF_ATT + 1,  dAngle->z);
+    ekfAddTransition(G, &count, EKF_ATT + 0, EKF_ATT + 2, -dAngle->y);
+    ekfAddTransition(G, &count, EKF_ATT + 1, EKF_ATT + 0, -dAngle->z);
+    ekfAddTransition(G, &count, EKF_ATT + 1, EKF_ATT + 2,  dAngle->x);
+    ekfAddTransition(G, &count, EKF_ATT + 2, EKF_ATT + 0,  dAngle->y);
+    ekfAddTransition(G, &count, EKF_ATT + 2, EKF_ATT + 1, -dAngle->x);
+
+    for (int i = 0; i < 3; i++) {
+        ekfAddTransition(G, &count, EKF_ATT + i, EKF_GYRO_BIAS + i, -dt);
+    }
+
+    // Column j is -(dVelocity x R e_j), R e_j is the body axis j in earth frame
+    for (int j = 0; j < 3; j++) {
+        const fpVector3_t vUnit = { .v = { j == 0, j == 1, j == 2 } };
+        fpVector3_t vAxisEF, vColumn;
+
+        quaternionRotateVectorInv(&vAxisEF, &vUnit, &ekfState.orientation);
+        vectorCrossProduct(&vColumn, dVelocity, &vAxisEF);
+
+        for (int i = 0; i < 3; i++) {
+            ekfAddTransition(G, &count, EKF_VEL + i, EKF_ATT + j, -vColumn.v[i]);
+        }
+    }
+
+    ekfAddTransition(G, &count, EKF_VEL + 2, EKF_ACC_BIAS_Z, -dt);
+
+    for (int i = 0; i < 3; i++) {
+        ekfAddTransition(G, &count, EKF_POS + i, EKF_VEL + i, dt);
+    }
+
+    // FP = P + G * P
+    memcpy(ekfFP, ekfP, sizeof(ekfFP));
+    for (int n = 0; n < count; n++) {
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            ekfFP[G[n].row][j] += G[n].value * ekfP[G[n].col][j];
+        }
+    }
+
+    // P = FP * F' = FP + FP * G'
+    memcpy(ekfP, ekfFP, sizeof(ekfP));
+    for (int n = 0; n < count; n++) {
+        for (int i = 0; i < EKF_STATE_COUNT; i++) {
+            ekfP[i][G[n].row] += G[n].value * ekfFP[i][G[n].col];
+        }
+    }
+
+    // Remove the rounding asymmetry
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        for (int j = i + 1; j < EKF_STATE_COUNT; j++) {
+            const float value = (ekfP[i][j] + ekfP[j][i]) * 0.5f;
+            ekfP[i][j] = value;
+            ekfP[j][i] = value;
+        }
+    }
+}
+
+static void ekfPropagateCovariance(void)
+{
+    const float dt = ekfCovarianceDt;
+    if (dt <= 0) {
+        return;
+    }
+
+    ekfPredictCovariance(&ekfGyroDeltaSum, &ekfVelocityDeltaSum, dt);
+
+    for (int i = 0; i < 3; i++) {
+        ekfP[EKF_ATT + i][EKF_ATT + i] += sq(EKF_GYRO_NOISE) * dt;
+        ekfP[EKF_VEL + i][EKF_VEL + i] += sq(EKF_ACC_PROCESS_NOISE) * dt;
+        ekfP[EKF_GYRO_BIAS + i][EKF_GYRO_BIAS + i] += sq(EKF_GYRO_BIAS_NOISE) * dt;
+    }
+    ekfP[EKF_WIND + 0][EKF_WIND + 0] += sq(EKF_WIND_NOISE) * dt;
+    ekfP[EKF_WIND + 1][EKF_WIND + 1] += sq(EKF_WIND_NOISE) * dt;
+    ekfP[EKF_ACC_BIAS_Z][EKF_ACC_BIAS_Z] += sq(EKF_ACC_BIAS_NOISE) * dt;
+
+    vectorZero(&ekfGyroDeltaSum);
+    vectorZero(&ekfVelocityDeltaSum);
+    ekfCovarianceDt = 0;
+
+    // Unaided states would only integrate accelerometer noise, keep them out of the solution
+    if (ekfHorizontalAidingAge > EKF_AIDING_TIMEOUT) {
+        static const fpVector3_t vZero = { .v = { 0.0f, 0.0f, 0.0f } };
+        ekfHorizontalAided = false;
+        ekfResetHorizontal(&vZero, &vZero, EKF_UNAIDED_VAR, EKF_UNAIDED_VAR);
+        ekfResetWind(EKF_UNAIDED_VAR);
+    }
+
+    if (ekfVerticalAidingAge > EKF_AIDING_TIMEOUT) {
+        ekfVerticalAided = false;
+        ekfResetVertical(0, 0, EKF_UNAIDED_VAR, EKF_UNAIDED_VAR);
+    }
+}
+
+// Returns false if the measurement failed the innovation gate
+STATIC_UNIT_TESTED bool ekfScalarUpdate(const float H[EKF_STATE_COUNT], float measurement, float R, bool useGate)
+{
+    float PHt[EKF_STATE_COUNT];
+    float innovation = measurement;
+    float S = R;
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        float sum = 0;
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            sum += ekfP[i][j] * H[j];
+        }
+        PHt[i] = sum;
+        S += H[i] * sum;
+        innovation -= H[i] * ekfX[i];
+    }
+
+    if (useGate && sq(innovation) > sq(EKF_INNOVATION_GATE) * S) {
+        return false;
+    }
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        const float K = PHt[i] / S;
+        ekfX[i] += K * innovation;
+
+        // P = P - K * H * P, H * P equals PHt' since P is symmetric
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            ekfP[i][j] -= K * PHt[j];
+        }
+    }
+
+    return true;
+}
+
+// Direct measurement of a single state
+static bool ekfStateUpdate(int index, float measurement, float R, bool useGate)
+{
+    float H[EKF_STATE_COUNT] = { 0 };
+    H[index] = 1.0f;
+
+    return ekfScalarUpdate(H, measurement, R, useGate);
+}
+
+/*
+ * Measurement models. Each returns the measurement predicted from the nominal
+ * state and fills in its Jacobian H with respect to the error state. A body
+ * frame vector v changes by v x dTheta with the attitude error, so for the
+ * component i: e_i . (v x dTheta) = (e_i x v) . dTheta
+ */
+STATIC_UNIT_TESTED float ekfPredictGravity(int axis, float H[EKF_STATE_COUNT])
+{
+    static const fpVector3_t vGravity = { .v = { 0.0f, 0.0f, 1.0f } };
+    const fpVector3_t vUnit = { .v = { axis == 0, axis == 1, axis == 2 } };
+    fpVector3_t vEstGravity, vRow;
+
+    quaternionRotateVector(&vEstGravity, &vGravity, &ekfState.orientation);
+    vectorCrossProduct(&vRow, &vUnit, &vEstGravity);
+
+    memset(H, 0, sizeof(float) * EKF_STATE_COUNT);
+    H[EKF_ATT + 0] = vRow.x;
+    H[EKF_ATT + 1] = vRow.y;
+    H[EKF_ATT + 2] = vRow.z;
+
+    return vEstGravity.v[axis];
+}
+
+static void ekfGetAirVelocity(fpVector3_t * vAirEF)
+{
+    vAirEF->x = ekfState.vel.x - ekfState.wind[0];
+    vAirEF->y = ekfState.vel.y - ekfState.wind[1];
+    vAirEF->z = ekfState.vel.z;
+}
+
+// Lateral airspeed in body frame, zero in coordinated flight of a plane
+STATIC_UNIT_TESTED float ekfPredictSideslip(float H[EKF_STATE_COUNT])
+{
+    static const fpVector3_t vLateral = { .v = { 0.0f, 1.0f, 0.0f } };
+    fpVector3_t vAirEF, vAirBF, vLateralEF, vRow;
+
+    ekfGetAirVelocity(&vAirEF);
+    quaternionRotateVector(&vAirBF, &vAirEF, &ekfState.orientation);
+    quaternionRotateVectorInv(&vLateralEF, &vLateral, &ekfState.orientation);
+    vectorCrossProduct(&vRow, &vLateral, &vAirBF);
+
+    memset(H, 0, sizeof(float) * EKF_STATE_COUNT);
+    for (int i = 0; i < 3; i++) {
+        H[EKF_ATT + i] = vRow.v[i];
+        H[EKF_VEL + i] = vLateralEF.v[i];
+    }
+    H[EKF_WIND + 0] = -vLateralEF.x;
+    H[EKF_WIND + 1] = -vLateralEF.y;
+
+    return vAirBF.y;
+}
+
+STATIC_UNIT_TESTED float ekfPredictAirspeed(float H[EKF_STATE_COUNT])
+{
+    fpVector3_t vAirEF;
+
+    ekfGetAirVelocity(&vAirEF);
+    const float airspeed = sqrtf(vectorNormSquared(&vAirEF));
+
+    memset(H, 0, sizeof(float) * EKF_STATE_COUNT);
+    if (airspeed > 0) {
+        for (int i = 0; i < 3; i++) {
+            H[EKF_VEL + i] = vAirEF.v[i] / airspeed;
+        }
+        H[EKF_WIND + 0] = -H[EKF_VEL + 0];
+        H[EKF_WIND + 1] = -H[EKF_VEL + 1];
+    }
+
+    return airspeed;
+}
+
+// Folds the estimated error into the nominal state
+STATIC_UNIT_TESTED void ekfApplyCorrection(void)
+{
+    const fpVector3_t vAttError = { .v = { ekfX[EKF_ATT + 0], ekfX[EKF_ATT + 1], ekfX[EKF_ATT + 2] } };
+
+    ekfRotate(&ekfState.orientation, &vAttError);
+
+    for (int axis = 0; axis < 3; axis++) {
+        ekfState.vel.v[axis] += ekfX[EKF_VEL + axis];
+        ekfState.pos.v[axis] += ekfX[EKF_POS + axis];
+        ekfState.gyroBias.v[axis] += ekfX[EKF_GYRO_BIAS + axis];
+    }
+
+    ekfState.wind[0] += ekfX[EKF_WIND + 0];
+    ekfState.wind[1] += ekfX[EKF_WIND + 1];
+    ekfState.accBiasZ += ekfX[EKF_ACC_BIAS_Z];
+
+    memset(ekfX, 0, sizeof(ekfX));
+
+    // Roll/pitch/yaw of the EKF solution and gyro bias for comparison with the main estimate
+    const fpQuaternion_t * q = &ekfState.orientation;
+    DEBUG_SET(DEBUG_EKF, 0, RADIANS_TO_DECIDEGREES(atan2_approx(2.0f * (q->q2 * q->q3 + q->q0 * q->q1), 1.0f - 2.0f * (sq(q->q1) + sq(q->q2)))));
+    DEBUG_SET(DEBUG_EKF, 1, RADIANS_TO_DECIDEGREES((0.5f * M_PIf) - acos_approx(-2.0f * (q->q1 * q->q3 - q->q0 * q->q2))));
+    DEBUG_SET(DEBUG_EKF, 2, RADIANS_TO_DECIDEGREES(-atan2_approx(2.0f * (q->q1 * q->q2 + q->q0 * q->q3), 1.0f - 2.0f * (sq(q->q2) + sq(q->q3)))));
+    DEBUG_SET(DEBUG_EKF, 3, RADIANS_TO_DEGREES(ekfState.gyroBias.x) * 100);
+    DEBUG_SET(DEBUG_EKF, 4, RADIANS_TO_DEGREES(ekfState.gyroBias.y) * 100);
+    DEBUG_SET(DEBUG_EKF, 5, RADIANS_TO_DEGREES(ekfState.gyroBias.z) * 100);
+    DEBUG_SET(DEBUG_EKF, 6, ekfGravityRejections);
+    DEBUG_SET(DEBUG_EKF, 7, ekfHeadingRejections);
+
+    // Velocity, altitude and wind in NEU for comparison with the position estimator
+    DEBUG_SET(DEBUG_EKF_NAV, 0, ekfState.vel.x);
+    DEBUG_SET(DEBUG_EKF_NAV, 1, -ekfState.vel.y);
+    DEBUG_SET(DEBUG_EKF_NAV, 2, ekfState.vel.z);
+    DEBUG_SET(DEBUG_EKF_NAV, 3, ekfState.pos.z);
+    DEBUG_SET(DEBUG_EKF_NAV, 4, ekfState.wind[0]);
+    DEBUG_SET(DEBUG_EKF_NAV, 5, -ekfState.wind[1]);
+    DEBUG_SET(DEBUG_EKF_NAV, 6, ekfGpsRejections);
+    DEBUG_SET(DEBUG_EKF_NAV, 7, ekfBaroRejections);
+}
+
+void imuEkfUpdateGravity(const fpVector3_t * accBF, float weight, bool useGate)
+{
+    fpVector3_t vAcc;
+    bool accepted = true;
+
+    ekfPropagateCovariance();
+
+    vectorNormalize(&vAcc, accBF);
+
+    const float R = sq(EKF_ACC_NOISE) / weight;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float H[EKF_STATE_COUNT];
+        const float estimated = ekfPredictGravity(axis, H);
+
+        accepted &= ekfScalarUpdate(H, vAcc.v[axis] - estimated, R, useGate);
+    }
+
+    if (accepted) {
+        ekfGravityRejections = 0;
+    }
+    else if (++ekfGravityRejections > EKF_MAX_REJECTIONS) {
+        // Estimate is probably wrong, let the measurements pull it back
+        ekfInflateAttitudeCovariance();
+        ekfGravityRejections = 0;
+    }
+
+    ekfApplyCorrection();
+}
+
+void imuEkfUpdateHeading(float headingError, float weight, bool useGate)
+{
+    static const fpVector3_t vUp = { .v = { 0.0f, 0.0f, 1.0f } };
+    fpVector3_t vAxisBF;
+    float H[EKF_STATE_COUNT] = { 0 };
+
+    ekfPropagateCovariance();
+
+    // Heading error is a rotation around EF Z axis
+    quaternionRotateVector(&vAxisBF, &vUp, &ekfState.orientation);
+    H[EKF_ATT + 0] = vAxisBF.x;
+    H[EKF_ATT + 1] = vAxisBF.y;
+    H[EKF_ATT + 2] = vAxisBF.z;
+
+    if (ekfScalarUpdate(H, headingError, sq(EKF_HEADING_NOISE) / weight, useGate)) {
+        ekfHeadingRejections = 0;
+    }
+    else if (++ekfHeadingRejections > EKF_MAX_REJECTIONS) {
+        ekfInflateAttitudeCovariance();
+        ekfHeadingRejections = 0;
+    }
+
+    ekfApplyCorrection();
+}
+
+void imuEkfUpdateGps(const fpVector3_t * posNEU, const fpVector3_t * velNEU, float eph, float epv, bool useAltitude, bool useGate)
+{
+    if (!ekfRunning) {
+        return;
+    }
+
+    ekfPropagateCovariance();
+
+    const fpVector3_t pos = { .v = { posNEU->x, -posNEU->y, posNEU->z } };
+    const fpVector3_t vel = { .v = { velNEU->x, -velNEU->y, velNEU->z } };
+    bool accepted = true;
+
+    if (ekfHorizontalAided) {
+        for (int axis = 0; axis < 2; axis++) {
+            accepted &= ekfStateUpdate(EKF_POS + axis, pos.v[axis] - ekfState.pos.v[axis], sq(eph), useGate);
+            accepted &= ekfStateUpdate(EKF_VEL + axis, vel.v[axis] - ekfState.vel.v[axis], sq(EKF_GPS_VEL_NOISE), useGate);
+        }
+    }
+    else {
+        ekfResetHorizontal(&pos, &vel, sq(eph), sq(EKF_GPS_VEL_NOISE));
+        ekfResetWind(EKF_INITIAL_WIND_VAR);
+        ekfHorizontalAided = true;
+    }
+
+    // GPS altitude is only used without baro, climb rate always
+    if (useAltitude) {
+        if (ekfVerticalAided) {
+            accepted &= ekfStateUpdate(EKF_POS + 2, pos.z - ekfState.pos.z, sq(epv), useGate);
+        }
+        else {
+            ekfResetVertical(pos.z, vel.z, sq(epv), sq(EKF_GPS_VEL_Z_NOISE));
+            ekfVerticalAided = true;
+        }
+        ekfVerticalAidingAge = 0;
+    }
+
+    if (ekfVerticalAided) {
+        accepted &= ekfStateUpdate(EKF_VEL + 2, vel.z - ekfState.vel.z, sq(EKF_GPS_VEL_Z_NOISE), useGate);
+    }
+
+    if (accepted) {
+        ekfGpsRejections = 0;
+    }
+    else if (++ekfGpsRejections > EKF_MAX_NAV_REJECTIONS) {
+        // Consistently rejected, it's the estimate that's off. Restart from GPS
+        ekfResetHorizontal(&pos, &vel, sq(eph), sq(EKF_GPS_VEL_NOISE));
+        if (useAltitude) {
+            ekfResetVertical(pos.z, vel.z, sq(epv), sq(EKF_GPS_VEL_Z_NOISE));
+        }
+    }
+
+    ekfHorizontalAidingAge = 0;
+    ekfApplyCorrection();
+}
+
+void imuEkfUpdateBaro(float altitude, float epv, bool useGate)
+{
+    if (!ekfRunning) {
+        return;
+    }
+
+    ekfPropagateCovariance();
+
+    if (!ekfVerticalAided) {
+        ekfResetVertical(altitude, 0, sq(epv), EKF_INITIAL_VEL_VAR);
+        ekfVerticalAided = true;
+    }
+    else if (ekfStateUpdate(EKF_POS + 2, altitude - ekfState.pos.z, sq(epv), useGate)) {
+        ekfBaroRejections = 0;
+    }
+    else if (++ekfBaroRejections > EKF_MAX_NAV_REJECTIONS) {
+        ekfResetVertical(altitude, ekfState.vel.z, sq(epv), EKF_INITIAL_VEL_VAR);
+    }
+
+    ekfVerticalAidingAge = 0;
+    ekfApplyCorrection();
+}
+
+/*
+ * Plane flies along its X axis relative to the air, which makes the wind
+ * observable from the GPS velocity. Airspeed is optional
+ */
+void imuEkfUpdateAirData(const float * airspeed)
+{
+    float H[EKF_STATE_COUNT];
+
+    if (!ekfRunning || !ekfHorizontalAided) {
+        return;
+    }
+
+    ekfPropagateCovariance();
+
+    const float estimatedAirspeed = ekfPredictAirspeed(H);
+    if (estimatedAirspeed < EKF_MIN_AIRSPEED) {
+        return;
+    }
+
+    if (airspeed) {
+        ekfScalarUpdate(H, *airspeed - estimatedAirspeed, sq(EKF_AIRSPEED_NOISE), true);
+    }
+
+    const float estimatedSideslip = ekfPredictSideslip(H);
+    ekfScalarUpdate(H, 0.0f - estimatedSideslip, sq(EKF_SIDESLIP_NOISE), true);
+
+    ekfApplyCorrection();
+}
+
+const fpQuaternion_t * imuEkfGetOrientation(void)
+{
+    return &ekfState.orientation;
+}
+
+// Position and velocity in NEU with their accuracy. Leaves the outputs untouched while the filter isn't running
+void imuEkfGetNavState(fpVector3_t * posNEU, fpVector3_t * velNEU, float * eph, float * epv)
+{
+    if (!ekfRunning) {
+        return;
+    }
+
+    posNEU->x = ekfState.pos.x;
+    posNEU->y = -ekfState.pos.y;
+    posNEU->z = ekfState.pos.z;
+    velNEU->x = ekfState.vel.x;
+    velNEU->y = -ekfState.vel.y;
+    velNEU->z = ekfState.vel.z;
+
+    *eph = sqrtf(ekfP[EKF_POS + 0][EKF_POS + 0] + ekfP[EKF_POS + 1][EKF_POS + 1]);
+    *epv = sqrtf(ekfP[EKF_POS + 2][EKF_POS + 2]);
+}
+
+#endif
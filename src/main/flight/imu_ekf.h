@@ -0,0 +1,50 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#if defined(USE_IMU_EKF)
+
+#include "common/quaternion.h"
+#include "common/vector.h"
+
+// Error state layout
+#define EKF_ATT                 0       // Attitude error, body frame (rad)
+#define EKF_VEL                 3       // Velocity, earth frame (cm/s)
+#define EKF_POS                 6       // Position, earth frame (cm)
+#define EKF_GYRO_BIAS           9       // Gyro bias (rad/s)
+#define EKF_WIND                12      // Horizontal wind, earth frame (cm/s)
+#define EKF_ACC_BIAS_Z          14      // Vertical accelerometer bias, earth frame (cm/s/s)
+#define EKF_STATE_COUNT         15
+
+void imuEkfReset(const fpQuaternion_t * initialOrientation);
+void imuEkfStop(void);
+
+// Gyro and accelerometer integration, runs on every IMU update
+void imuEkfPredict(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF);
+
+// Sequential scalar measurement updates
+void imuEkfUpdateGravity(const fpVector3_t * accBF, float weight, bool useGate);
+void imuEkfUpdateHeading(float headingError, float weight, bool useGate);
+void imuEkfUpdateGps(const fpVector3_t * posNEU, const fpVector3_t * velNEU, float eph, float epv, bool useAltitude, bool useGate);
+void imuEkfUpdateBaro(float altitude, float epv, bool useGate);
+void imuEkfUpdateAirData(const float * airspeed);
+
+const fpQuaternion_t * imuEkfGetOrientation(void);
+void imuEkfGetNavState(fpVector3_t * posNEU, fpVector3_t * velNEU, float * eph, float * epv);
+
+#endif
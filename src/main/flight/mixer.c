@@ -59,6 +59,9 @@ FASTRAM int16_t motor_disarmed[MAX_SUPPORTED_MOTORS];
 static float motorMixRange;
 static float mixerScale = 1.0f;
 static EXTENDED_FASTRAM motorMixer_t currentMixer[MAX_SUPPORTED_MOTORS];
+// currentMixer with mixerScale and yaw motor direction folded in, see mixerCompileMotorMatrix()
+static EXTENDED_FASTRAM motorMixer_t motorMixMatrix[MAX_SUPPORTED_MOTORS];
+static EXTENDED_FASTRAM int8_t motorMixYawDirection;
 static EXTENDED_FASTRAM uint8_t motorCount = 0;
 EXTENDED_FASTRAM int mixerThrottleCommand;
 
@@ -93,7 +96,7 @@ PG_RESET_TEMPLATE(mixerConfig_t, mixerConfig,
 
 #define DEFAULT_MAX_THROTTLE    1850
 
-PG_REGISTER_WITH_RESET_TEMPLATE(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 4);
+PG_REGISTER_WITH_RESET_TEMPLATE(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 5);
 
 PG_RESET_TEMPLATE(motorConfig_t, motorConfig,
     .minthrottle = DEFAULT_MIN_THROTTLE,
@@ -105,7 +108,8 @@ PG_RESET_TEMPLATE(motorConfig_t, motorConfig,
     .motorDecelTimeMs = 0,
     .digitalIdleOffsetValue = 450,  // Same scale as in Betaflight
     .throttleScale = 1.0f,
-    .motorPoleCount = 14            // Most brushless motors that we use are 14 poles
+    .motorPoleCount = 14,           // Most brushless motors that we use are 14 poles
+    .dshotBidir = false,
 );
 
 PG_REGISTER_ARRAY(motorMixer_t, MAX_SUPPORTED_MOTORS, primaryMotorMixer, PG_MOTOR_MIXER, 0);
@@ -147,6 +151,8 @@ void mixerUpdateStateFlags(void)
         DISABLE_STATE(FIXED_WING);
     }
 
+    pidSelectRateController();
+
     if (mixerConfig()->hasFlaps) {
         ENABLE_STATE(FLAPERON_AVAILABLE);
     } else {
@@ -154,14 +160,26 @@ void mixerUpdateStateFlags(void)
     }
 }
 
+static void mixerCompileMotorMatrix(void)
+{
+    motorMixYawDirection = mixerConfig()->yaw_motor_direction;
+
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        motorMixMatrix[i].throttle = currentMixer[i].throttle;
+        motorMixMatrix[i].roll = currentMixer[i].roll * mixerScale;
+        motorMixMatrix[i].pitch = currentMixer[i].pitch * mixerScale;
+        motorMixMatrix[i].yaw = -motorMixYawDirection * currentMixer[i].yaw * mixerScale;
+    }
+}
+
 void mixerInit(void)
 {
     computeMotorCount();
-    loadPrimaryMotorMixer();
     // in 3D mode, mixer gain has to be halved
     if (feature(FEATURE_3D)) {
         mixerScale = 0.5f;
     }
+    loadPrimaryMotorMixer();
 
     mixerResetDisarmedMotors();
 }
@@ -176,15 +194,20 @@ void mixerResetDisarmedMotors(void)
 
 void FAST_CODE NOINLINE writeMotors(void)
 {
+#ifdef USE_DSHOT
+    // Same for all motors, evaluate once per update
+    const bool isDigital = isMotorProtocolDigital();
+    const bool is3D = feature(FEATURE_3D);
+    const float dshotMinThrottleOffset = (DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE) / 10000.0f * motorConfig()->digitalIdleOffsetValue;
+#endif
+
     for (int i = 0; i < motorCount; i++) {
         uint16_t motorValue;
 
 #ifdef USE_DSHOT
         // If we use DSHOT we need to convert motorValue to DSHOT ranges
-        if (isMotorProtocolDigital()) {
-            const float dshotMinThrottleOffset = (DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE) / 10000.0f * motorConfig()->digitalIdleOffsetValue;
-
-            if (feature(FEATURE_3D)) {
+        if (isDigital) {
+            if (is3D) {
                 if (motor[i] >= motorConfig()->minthrottle && motor[i] <= flight3DConfig()->deadband3d_low) {
                     motorValue = scaleRangef(motor[i], motorConfig()->minthrottle, flight3DConfig()->deadband3d_low, DSHOT_3D_DEADBAND_LOW, dshotMinThrottleOffset + DSHOT_MIN_THROTTLE);
                     motorValue = constrain(motorValue, DSHOT_MIN_THROTTLE, DSHOT_3D_DEADBAND_LOW);
@@ -280,6 +303,7 @@ static void applyMotorRateLimiting(const float dT)
 
 void FAST_CODE NOINLINE mixTable(const float dT)
 {
+    const bool is3D = feature(FEATURE_3D);
     int16_t input[3];   // RPY, range [-500:+500]
     // Allow direct stick input to motors in passthrough mode on airplanes
     if (STATE(FIXED_WING) && FLIGHT_MODE(MANUAL_MODE)) {
@@ -304,12 +328,18 @@ void FAST_CODE NOINLINE mixTable(const float dT)
     int16_t rpyMixMax = 0; // assumption: symetrical about zero.
     int16_t rpyMixMin = 0;
 
+    // yaw_motor_direction can be changed at runtime from CLI and MSP
+    if (mixerConfig()->yaw_motor_direction != motorMixYawDirection) {
+        mixerCompileMotorMatrix();
+    }
+
     // motors for non-servo mixes
+    const float inputRoll = input[ROLL];
+    const float inputPitch = input[PITCH];
+    const float inputYaw = input[YAW];
+
     for (int i = 0; i < motorCount; i++) {
-        rpyMix[i] =
-            (input[PITCH] * currentMixer[i].pitch +
-            input[ROLL] * currentMixer[i].roll +
-            -mixerConfig()->yaw_motor_direction * input[YAW] * currentMixer[i].yaw) * mixerScale;
+        rpyMix[i] = inputPitch * motorMixMatrix[i].pitch + inputRoll * motorMixMatrix[i].roll + inputYaw * motorMixMatrix[i].yaw;
 
         if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
         if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
@@ -328,7 +358,7 @@ void FAST_CODE NOINLINE mixTable(const float dT)
         mixerThrottleCommand = constrain(globalFunctionValues[GLOBAL_FUNCTION_ACTION_OVERRIDE_THROTTLE], throttleMin, throttleMax); 
     } else
 #endif
-    if (feature(FEATURE_3D)) {
+    if (is3D) {
         if (!ARMING_FLAG(ARMED)) throttlePrevious = PWM_RANGE_MIDDLE; // When disarmed set to mid_rc. It always results in positive direction after arming.
 
         if ((rcCommand[THROTTLE] <= (PWM_RANGE_MIDDLE - rcControlsConfig()->deadband3d_throttle))) { // Out of band handling
@@ -383,28 +413,40 @@ void FAST_CODE NOINLINE mixTable(const float dT)
     // Now add in the desired throttle, but keep in a range that doesn't clip adjusted
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
     if (ARMING_FLAG(ARMED)) {
-        for (int i = 0; i < motorCount; i++) {
-            motor[i] = rpyMix[i] + constrain(mixerThrottleCommand * currentMixer[i].throttle, throttleMin, throttleMax);
-
-            if (failsafeIsActive()) {
-                motor[i] = constrain(motor[i], motorConfig()->mincommand, motorConfig()->maxthrottle);
-            } else if (feature(FEATURE_3D)) {
-                if (throttlePrevious <= (PWM_RANGE_MIDDLE - rcControlsConfig()->deadband3d_throttle)) {
-                    motor[i] = constrain(motor[i], motorConfig()->minthrottle, flight3DConfig()->deadband3d_low);
-                } else {
-                    motor[i] = constrain(motor[i], flight3DConfig()->deadband3d_high, motorConfig()->maxthrottle);
-                }
+        // Output limits and motor stop are the same for all motors
+        int16_t motorMin, motorMax;
+        if (failsafeIsActive()) {
+            motorMin = motorConfig()->mincommand;
+            motorMax = motorConfig()->maxthrottle;
+        } else if (is3D) {
+            if (throttlePrevious <= (PWM_RANGE_MIDDLE - rcControlsConfig()->deadband3d_throttle)) {
+                motorMin = motorConfig()->minthrottle;
+                motorMax = flight3DConfig()->deadband3d_low;
             } else {
-                motor[i] = constrain(motor[i], motorConfig()->minthrottle, motorConfig()->maxthrottle);
+                motorMin = flight3DConfig()->deadband3d_high;
+                motorMax = motorConfig()->maxthrottle;
             }
+        } else {
+            motorMin = motorConfig()->minthrottle;
+            motorMax = motorConfig()->maxthrottle;
+        }
 
+        if (getMotorStatus() != MOTOR_RUNNING) {
             // Motor stop handling
-            if (ARMING_FLAG(ARMED) && (getMotorStatus() != MOTOR_RUNNING)) {
-                if (feature(FEATURE_MOTOR_STOP)) {
-                    motor[i] = (feature(FEATURE_3D) ? PWM_RANGE_MIDDLE : motorConfig()->mincommand);
-                } else {
-                    motor[i] = motorConfig()->minthrottle;
-                }
+            int16_t motorStopValue;
+            if (feature(FEATURE_MOTOR_STOP)) {
+                motorStopValue = is3D ? PWM_RANGE_MIDDLE : motorConfig()->mincommand;
+            } else {
+                motorStopValue = motorConfig()->minthrottle;
+            }
+
+            for (int i = 0; i < motorCount; i++) {
+                motor[i] = motorStopValue;
+            }
+        } else {
+            for (int i = 0; i < motorCount; i++) {
+                motor[i] = rpyMix[i] + constrain(mixerThrottleCommand * motorMixMatrix[i].throttle, throttleMin, throttleMax);
+                motor[i] = constrain(motor[i], motorMin, motorMax);
             }
         }
     } else {
@@ -436,4 +478,6 @@ void loadPrimaryMotorMixer(void) {
     for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
         currentMixer[i] = *primaryMotorMixer(i);
     }
+
+    mixerCompileMotorMatrix();
 }
\ No newline at end of file
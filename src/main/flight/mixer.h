@@ -93,6 +93,7 @@ typedef struct motorConfig_s {
     uint16_t digitalIdleOffsetValue;
     float throttleScale;                    // Scaling factor for throttle.
     uint8_t motorPoleCount;                 // Magnetic poles in the motors for calculating actual RPM from eRPM provided by ESC telemetry
+    bool dshotBidir;                        // Request eRPM telemetry from the ESCs on the DSHOT signal wire
 } motorConfig_t;
 
 PG_DECLARE(motorConfig_t, motorConfig);
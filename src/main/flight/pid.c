@@ -107,6 +107,7 @@ STATIC_FASTRAM pt1Filter_t headingHoldRateFilter;
 STATIC_FASTRAM pt1Filter_t fixedWingTpaFilter;
 
 // Thrust PID Attenuation factor. 0.0f means fully attenuated, 1.0f no attenuation is applied
+STATIC_FASTRAM float currentTpaFactor;
 STATIC_FASTRAM bool pidGainsUpdateRequired;
 FASTRAM int16_t axisPID[FLIGHT_DYNAMICS_INDEX_COUNT];
 
@@ -138,6 +139,15 @@ static EXTENDED_FASTRAM float dBoostMaxAtAlleceleration;
 
 static EXTENDED_FASTRAM uint16_t yawPLimit;
 static EXTENDED_FASTRAM uint8_t yawLpfHz;
+static EXTENDED_FASTRAM float motorItermWindupPoint;
+
+// Rate controller is chosen by pidSelectRateController() when the airframe type changes instead of being branched on every loop
+typedef void (*pidControllerFnPtr)(pidState_t *pidState, flight_dynamics_index_t axis, float dT);
+static EXTENDED_FASTRAM pidControllerFnPtr pidControllerApplyFn;
+static EXTENDED_FASTRAM bool pidControllerIsFixedWing;
+
+static void pidApplyFixedWingRateController(pidState_t *pidState, flight_dynamics_index_t axis, float dT);
+static void pidApplyMulticopterRateController(pidState_t *pidState, flight_dynamics_index_t axis, float dT);
 
 PG_REGISTER_PROFILE_WITH_RESET_TEMPLATE(pidProfile_t, pidProfile, PG_PID_PROFILE, 10);
 
@@ -246,6 +256,16 @@ PG_RESET_TEMPLATE(pidProfile_t, pidProfile,
         .antigravityCutoff = ANTI_GRAVITY_THROTTLE_FILTER_CUTOFF,
 );
 
+void pidSelectRateController(void)
+{
+    // Follow FIXED_WING state so the controller matches pidBank() after the platform is changed over MSP
+    pidControllerIsFixedWing = STATE(FIXED_WING);
+    pidControllerApplyFn = pidControllerIsFixedWing ? pidApplyFixedWingRateController : pidApplyMulticopterRateController;
+
+    // Gains are derived from the PID bank and TPA settings of the active profile, refresh them on next loop
+    pidGainsUpdateRequired = true;
+}
+
 void pidInit(void)
 {
     pidResetTPAFilter();
@@ -254,7 +274,7 @@ void pidInit(void)
     headingHoldCosZLimit = cos_approx(DECIDEGREES_TO_RADIANS(pidProfile()->max_angle_inclination[FD_ROLL])) *
                            cos_approx(DECIDEGREES_TO_RADIANS(pidProfile()->max_angle_inclination[FD_PITCH]));
 
-    pidGainsUpdateRequired = false;
+    pidSelectRateController();
 
     itermRelax = pidProfile()->iterm_relax;
     itermRelaxType = pidProfile()->iterm_relax_type;
@@ -266,6 +286,7 @@ void pidInit(void)
         yawPLimit = 0;
     }
     yawLpfHz = pidProfile()->yaw_lpf_hz;
+    motorItermWindupPoint = 1.0f - (pidProfile()->itermWindupPointPercent / 100.0f);
 
 #ifdef USE_D_BOOST
     dBoostFactor = pidProfile()->dBoostFactor;
@@ -434,6 +455,11 @@ static float calculateMultirotorTPAFactor(void)
     return tpaFactor;
 }
 
+static float calculateTPAFactor(uint16_t throttle)
+{
+    return pidControllerIsFixedWing ? calculateFixedWingTPAFactor(throttle) : calculateMultirotorTPAFactor();
+}
+
 void schedulePidGainsUpdate(void)
 {
     pidGainsUpdateRequired = true;
@@ -442,24 +468,34 @@ void schedulePidGainsUpdate(void)
 void FAST_CODE NOINLINE updatePIDCoefficients(float dT)
 {
     STATIC_FASTRAM uint16_t prevThrottle = 0;
+    bool throttleChanged = false;
 
     // Check if throttle changed. Different logic for fixed wing vs multirotor
-    if (STATE(FIXED_WING) && (currentControlRateProfile->throttle.fixedWingTauMs > 0)) {
+    if (pidControllerIsFixedWing && (currentControlRateProfile->throttle.fixedWingTauMs > 0)) {
         uint16_t filteredThrottle = pt1FilterApply3(&fixedWingTpaFilter, rcCommand[THROTTLE], dT);
         if (filteredThrottle != prevThrottle) {
             prevThrottle = filteredThrottle;
-            pidGainsUpdateRequired = true;
+            throttleChanged = true;
         }
     }
     else {
         if (rcCommand[THROTTLE] != prevThrottle) {
             prevThrottle = rcCommand[THROTTLE];
+            throttleChanged = true;
+        }
+    }
+
+    // Throttle below TPA breakpoint (or TPA disabled) leaves the factor unchanged, no need to touch the gains
+    if (throttleChanged && !pidGainsUpdateRequired) {
+        const float newTpaFactor = calculateTPAFactor(prevThrottle);
+        if (newTpaFactor != currentTpaFactor) {
+            currentTpaFactor = newTpaFactor;
             pidGainsUpdateRequired = true;
         }
     }
 
 #ifdef USE_ANTIGRAVITY
-    if (!STATE(FIXED_WING)) {
+    if (!pidControllerIsFixedWing) {
         antigravityThrottleHpf = rcCommand[THROTTLE] - pt1FilterApply(&antigravityThrottleLpf, rcCommand[THROTTLE]);
     }
 #endif
@@ -476,21 +512,23 @@ void FAST_CODE NOINLINE updatePIDCoefficients(float dT)
         return;
     }
 
-    const float tpaFactor = STATE(FIXED_WING) ? calculateFixedWingTPAFactor(prevThrottle) : calculateMultirotorTPAFactor();
+    // TPA settings may have been changed along with the PIDs
+    currentTpaFactor = calculateTPAFactor(prevThrottle);
 
-    // PID coefficients can be update only with THROTTLE and TPA or inflight PID adjustments
-    //TODO: Next step would be to update those only at THROTTLE or inflight adjustments change
-    for (int axis = 0; axis < 3; axis++) {
-        if (STATE(FIXED_WING)) {
+    // PID coefficients are updated only on TPA factor change or inflight PID adjustments
+    if (pidControllerIsFixedWing) {
+        for (int axis = 0; axis < 3; axis++) {
             // Airplanes - scale all PIDs according to TPA
-            pidState[axis].kP  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER  * tpaFactor;
-            pidState[axis].kI  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER  * tpaFactor;
+            pidState[axis].kP  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER  * currentTpaFactor;
+            pidState[axis].kI  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER  * currentTpaFactor;
             pidState[axis].kD  = 0.0f;
-            pidState[axis].kFF = pidBank()->pid[axis].FF / FP_PID_RATE_FF_MULTIPLIER * tpaFactor;
+            pidState[axis].kFF = pidBank()->pid[axis].FF / FP_PID_RATE_FF_MULTIPLIER * currentTpaFactor;
             pidState[axis].kT  = 0.0f;
         }
-        else {
-            const float axisTPA = (axis == FD_YAW) ? 1.0f : tpaFactor;
+    }
+    else {
+        for (int axis = 0; axis < 3; axis++) {
+            const float axisTPA = (axis == FD_YAW) ? 1.0f : currentTpaFactor;
             pidState[axis].kP  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER * axisTPA;
             pidState[axis].kI  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER;
             pidState[axis].kD  = pidBank()->pid[axis].D / FP_PID_RATE_D_MULTIPLIER * axisTPA;
@@ -744,7 +782,6 @@ static void FAST_CODE pidApplyMulticopterRateController(pidState_t *pidState, fl
     const float newOutputLimited = constrainf(newOutput, -pidProfile()->pidSumLimit, +pidProfile()->pidSumLimit);
 
     // Prevent strong Iterm accumulation during stick inputs
-    const float motorItermWindupPoint = 1.0f - (pidProfile()->itermWindupPointPercent / 100.0f);
     const float antiWindupScaler = constrainf((1.0f - getMotorMixRange()) / motorItermWindupPoint, 0.0f, 1.0f);
 
     float itermErrorRate = rateError;
@@ -1015,13 +1052,7 @@ void FAST_CODE pidController(float dT)
 
     // Step 4: Run gyro-driven control
     for (int axis = 0; axis < 3; axis++) {
-        // Apply PID setpoint controller
-        if (STATE(FIXED_WING)) {
-            pidApplyFixedWingRateController(&pidState[axis], axis, dT);
-        }
-        else {
-            pidApplyMulticopterRateController(&pidState[axis], axis, dT);
-        }
+        pidControllerApplyFn(&pidState[axis], axis, dT);
     }
 }
 
@@ -162,6 +162,7 @@ extern int16_t axisPID[];
 extern int32_t axisPID_P[], axisPID_I[], axisPID_D[], axisPID_Setpoint[];
 
 void pidInit(void);
+void pidSelectRateController(void);
 
 #ifdef USE_DTERM_NOTCH
 bool pidInitFilters(void);
@@ -96,6 +96,9 @@ void pgResetFn_servoParams(servoParam_t *instance)
 int16_t servo[MAX_SUPPORTED_SERVOS];
 
 static uint8_t servoRuleCount = 0;
+static uint8_t servoStaticRuleCount = 0;    // Rules without speed limit and condition, sorted first in currentServoMixer
+static bool servoMixerUsesRcInputs;
+static bool servoMixerReverseYawIn3D;
 static servoMixer_t currentServoMixer[MAX_SERVO_RULES];
 static int servoOutputEnabled;
 
@@ -159,6 +162,53 @@ int getServoCount(void)
     }
 }
 
+static bool servoMixerRuleIsStatic(const servoMixer_t * rule)
+{
+#ifdef USE_LOGIC_CONDITIONS
+    if (rule->conditionId >= 0) {
+        return false;
+    }
+#endif
+    return rule->speed == 0;
+}
+
+static bool servoMixerInputIsRc(uint8_t inputSource)
+{
+    return (inputSource >= INPUT_RC_ROLL && inputSource <= INPUT_RC_CH8) ||
+           (inputSource >= INPUT_RC_CH9 && inputSource <= INPUT_RC_CH16);
+}
+
+/*
+ * Prepare the loaded rules for servoMixer(). Rules which are plain
+ * multiply-accumulate are moved in front (keeping their order) so
+ * the hot loop doesn't need to check conditions or speed filters for them.
+ */
+static void servoCompileMixer(void)
+{
+    servoMixer_t dynamicRules[MAX_SERVO_RULES];
+    uint8_t dynamicRuleCount = 0;
+
+    servoStaticRuleCount = 0;
+    servoMixerUsesRcInputs = false;
+
+    for (int i = 0; i < servoRuleCount; i++) {
+        if (servoMixerRuleIsStatic(&currentServoMixer[i])) {
+            currentServoMixer[servoStaticRuleCount++] = currentServoMixer[i];
+        } else {
+            dynamicRules[dynamicRuleCount++] = currentServoMixer[i];
+        }
+
+        if (servoMixerInputIsRc(currentServoMixer[i].inputSource)) {
+            servoMixerUsesRcInputs = true;
+        }
+    }
+
+    memcpy(&currentServoMixer[servoStaticRuleCount], dynamicRules, dynamicRuleCount * sizeof(servoMixer_t));
+
+    servoMixerReverseYawIn3D = feature(FEATURE_3D) &&
+        (mixerConfig()->platformType == PLATFORM_MULTIROTOR || mixerConfig()->platformType == PLATFORM_TRICOPTER);
+}
+
 void loadCustomServoMixer(void)
 {
     // reset settings
@@ -184,6 +234,8 @@ void loadCustomServoMixer(void)
         memcpy(&currentServoMixer[i], customServoMixers(i), sizeof(servoMixer_t));
         servoRuleCount++;
     }
+
+    servoCompileMixer();
 }
 
 static void filterServos(void)
@@ -192,7 +244,7 @@ static void filterServos(void)
         // Initialize servo lowpass filter (servos are calculated at looptime rate)
         if (!servoFilterIsSet) {
             for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-                biquadFilterInitLPF(&servoFilter[i], servoConfig()->servo_lowpass_freq, gyro.targetLooptime);
+                biquadFilterInitLPF(&servoFilter[i], servoConfig()->servo_lowpass_freq, getLooptime());
                 biquadFilterReset(&servoFilter[i], servo[i]);
             }
             servoFilterIsSet = true;
@@ -247,8 +299,7 @@ void servoMixer(float dT)
         input[INPUT_STABILIZED_YAW] = axisPID[YAW];
 
         // Reverse yaw servo when inverted in 3D mode only for multirotor and tricopter
-        if (feature(FEATURE_3D) && (rxGetChannelValue(THROTTLE) < PWM_RANGE_MIDDLE) &&
-        (mixerConfig()->platformType == PLATFORM_MULTIROTOR || mixerConfig()->platformType == PLATFORM_TRICOPTER)) {
+        if (servoMixerReverseYawIn3D && (rxGetChannelValue(THROTTLE) < PWM_RANGE_MIDDLE)) {
             input[INPUT_STABILIZED_YAW] *= -1;
         }
     }
@@ -280,31 +331,36 @@ void servoMixer(float dT)
     // 2000 - 1500 = +500
     // 1500 - 1500 = 0
     // 1000 - 1500 = -500
+    if (servoMixerUsesRcInputs) {
 #define GET_RX_CHANNEL_INPUT(x) (rxGetChannelValue(x) - PWM_RANGE_MIDDLE)
-    input[INPUT_RC_ROLL]     = GET_RX_CHANNEL_INPUT(ROLL);
-    input[INPUT_RC_PITCH]    = GET_RX_CHANNEL_INPUT(PITCH);
-    input[INPUT_RC_YAW]      = GET_RX_CHANNEL_INPUT(YAW);
-    input[INPUT_RC_THROTTLE] = GET_RX_CHANNEL_INPUT(THROTTLE);
-    input[INPUT_RC_CH5]      = GET_RX_CHANNEL_INPUT(AUX1);
-    input[INPUT_RC_CH6]      = GET_RX_CHANNEL_INPUT(AUX2);
-    input[INPUT_RC_CH7]      = GET_RX_CHANNEL_INPUT(AUX3);
-    input[INPUT_RC_CH8]      = GET_RX_CHANNEL_INPUT(AUX4);
-    input[INPUT_RC_CH9]      = GET_RX_CHANNEL_INPUT(AUX5);
-    input[INPUT_RC_CH10]     = GET_RX_CHANNEL_INPUT(AUX6);
-    input[INPUT_RC_CH11]     = GET_RX_CHANNEL_INPUT(AUX7);
-    input[INPUT_RC_CH12]     = GET_RX_CHANNEL_INPUT(AUX8);
-    input[INPUT_RC_CH13]     = GET_RX_CHANNEL_INPUT(AUX9);
-    input[INPUT_RC_CH14]     = GET_RX_CHANNEL_INPUT(AUX10);
-    input[INPUT_RC_CH15]     = GET_RX_CHANNEL_INPUT(AUX11);
-    input[INPUT_RC_CH16]     = GET_RX_CHANNEL_INPUT(AUX12);
+        input[INPUT_RC_ROLL]     = GET_RX_CHANNEL_INPUT(ROLL);
+        input[INPUT_RC_PITCH]    = GET_RX_CHANNEL_INPUT(PITCH);
+        input[INPUT_RC_YAW]      = GET_RX_CHANNEL_INPUT(YAW);
+        input[INPUT_RC_THROTTLE] = GET_RX_CHANNEL_INPUT(THROTTLE);
+        input[INPUT_RC_CH5]      = GET_RX_CHANNEL_INPUT(AUX1);
+        input[INPUT_RC_CH6]      = GET_RX_CHANNEL_INPUT(AUX2);
+        input[INPUT_RC_CH7]      = GET_RX_CHANNEL_INPUT(AUX3);
+        input[INPUT_RC_CH8]      = GET_RX_CHANNEL_INPUT(AUX4);
+        input[INPUT_RC_CH9]      = GET_RX_CHANNEL_INPUT(AUX5);
+        input[INPUT_RC_CH10]     = GET_RX_CHANNEL_INPUT(AUX6);
+        input[INPUT_RC_CH11]     = GET_RX_CHANNEL_INPUT(AUX7);
+        input[INPUT_RC_CH12]     = GET_RX_CHANNEL_INPUT(AUX8);
+        input[INPUT_RC_CH13]     = GET_RX_CHANNEL_INPUT(AUX9);
+        input[INPUT_RC_CH14]     = GET_RX_CHANNEL_INPUT(AUX10);
+        input[INPUT_RC_CH15]     = GET_RX_CHANNEL_INPUT(AUX11);
+        input[INPUT_RC_CH16]     = GET_RX_CHANNEL_INPUT(AUX12);
 #undef GET_RX_CHANNEL_INPUT
+    }
 
-    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-        servo[i] = 0;
+    int32_t servoMix[MAX_SUPPORTED_SERVOS] = { 0 };
+
+    // Static rules, plain multiply-accumulate
+    for (int i = 0; i < servoStaticRuleCount; i++) {
+        servoMix[currentServoMixer[i].targetChannel] += ((int32_t)input[currentServoMixer[i].inputSource] * currentServoMixer[i].rate) / 100;
     }
 
-    // mix servos according to rules
-    for (int i = 0; i < servoRuleCount; i++) {
+    // mix servos according to the remaining rules
+    for (int i = servoStaticRuleCount; i < servoRuleCount; i++) {
 
         /*
          * Check if conditions for a rule are met, not all conditions apply all the time
@@ -327,7 +383,7 @@ void servoMixer(float dT)
          */
         int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[i], input[from], currentServoMixer[i].speed * 10, dT);
 
-        servo[target] += ((int32_t)inputLimited * currentServoMixer[i].rate) / 100;
+        servoMix[target] += ((int32_t)inputLimited * currentServoMixer[i].rate) / 100;
     }
 
     for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
@@ -335,7 +391,7 @@ void servoMixer(float dT)
         /*
          * Apply servo rate
          */
-        servo[i] = ((int32_t)servoParams(i)->rate * servo[i]) / 100L;
+        servo[i] = ((int32_t)servoParams(i)->rate * (int16_t)servoMix[i]) / 100L;
 
         /*
          * Perform acumulated servo output scaling to match servo min and max values
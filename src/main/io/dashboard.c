@@ -451,6 +451,10 @@ void dashboardUpdate(timeUs_t currentTimeUs)
     bool updateNow = (int32_t)(currentTimeUs - nextDisplayUpdateAt) >= 0L;
 
     if (!updateNow) {
+        // Send what didn't fit in the previous flush
+        if (displayPresent) {
+            i2c_OLED_flush();
+        }
         return;
     }
 
@@ -520,6 +524,8 @@ void dashboardUpdate(timeUs_t currentTimeUs)
         updateRxStatus();
         updateTicker();
     }
+
+    i2c_OLED_flush();
 }
 
 void dashboardSetPage(pageId_e newPageId)
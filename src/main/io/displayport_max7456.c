@@ -30,6 +30,7 @@
 #include "drivers/display.h"
 #include "drivers/display_font_metadata.h"
 #include "drivers/max7456.h"
+#include "drivers/osd.h"
 
 #include "io/displayport_max7456.h"
 
@@ -77,6 +78,21 @@ static int drawScreen(displayPort_t *displayPort)
     return 0;
 }
 
+static void beginTransaction(displayPort_t *displayPort, displayTransactionOption_e opts)
+{
+    UNUSED(displayPort);
+    UNUSED(opts);
+
+    osdCharacterGridBufferBeginFrame();
+}
+
+static void commitTransaction(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+
+    osdCharacterGridBufferCommitFrame();
+}
+
 static int screenSize(const displayPort_t *displayPort)
 {
     UNUSED(displayPort);
@@ -111,6 +127,12 @@ static bool isTransferInProgress(const displayPort_t *displayPort)
     return false;
 }
 
+static bool hasPendingChanges(const displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return osdCharacterGridBufferHasDirty();
+}
+
 static void resync(displayPort_t *displayPort)
 {
     UNUSED(displayPort);
@@ -180,10 +202,13 @@ static const displayPortVTable_t max7456VTable = {
     .writeChar = writeChar,
     .readChar = readChar,
     .isTransferInProgress = isTransferInProgress,
+    .hasPendingChanges = hasPendingChanges,
     .heartbeat = heartbeat,
     .resync = resync,
     .txBytesFree = txBytesFree,
     .supportedTextAttributes = supportedTextAttributes,
+    .beginTransaction = beginTransaction,
+    .commitTransaction = commitTransaction,
     .getFontMetadata = getFontMetadata,
     .writeFontCharacter = writeFontCharacter,
 };
@@ -30,6 +30,8 @@
 #include "config/parameter_group_ids.h"
 
 #include "drivers/display.h"
+#include "drivers/osd.h"
+#include "drivers/time.h"
 
 #include "fc/fc_msp.h"
 
@@ -38,8 +40,31 @@
 #include "msp/msp_protocol.h"
 #include "msp/msp_serial.h"
 
+#define MSP_DISPLAYPORT_ROWS                13
+#define MSP_DISPLAYPORT_COLS                30
+#define MSP_DISPLAYPORT_CHARS               (MSP_DISPLAYPORT_ROWS * MSP_DISPLAYPORT_COLS)
+
+STATIC_ASSERT(MSP_DISPLAYPORT_COLS == OSD_CHARACTER_GRID_MAX_WIDTH, msp_displayport_cols_must_match_osd_grid);
+STATIC_ASSERT(MSP_DISPLAYPORT_ROWS <= OSD_CHARACTER_GRID_MAX_HEIGHT, msp_displayport_rows_must_fit_osd_grid);
+// MSPv1 framing plus the write string subcommand header
+#define MSP_DISPLAYPORT_STRING_OVERHEAD     (6 + 4)
+// Clean chars between two dirty ones are sent along when it's cheaper
+// than starting a new string
+#define MSP_DISPLAYPORT_MAX_GAP             MSP_DISPLAYPORT_STRING_OVERHEAD
+// One row is sent again every interval even if unchanged, so the remote
+// screen recovers if it was cleared behind our back (e.g. goggles reboot)
+#define MSP_DISPLAYPORT_ROW_REFRESH_MS      100
+
 static displayPort_t mspDisplayPort;
 
+// Strings are written to the OSD character grid and only the dirty chars
+// are sent on drawScreen(), so elements redrawn with the same contents
+// cost no bandwidth. Whatever doesn't fit in the TX buffer stays dirty
+// until the next drawScreen().
+static bool clearPending;
+static uint8_t refreshRow;
+static timeMs_t refreshRowAt;
+
 extern uint8_t cliMode;
 
 static int output(displayPort_t *displayPort, uint8_t cmd, uint8_t *buf, int len)
@@ -75,19 +100,117 @@ static int release(displayPort_t *displayPort)
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
 
-static int clearScreen(displayPort_t *displayPort)
+static int sendClearScreen(displayPort_t *displayPort)
 {
     uint8_t subcmd[] = { 2 };
 
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
 
+static int clearScreen(displayPort_t *displayPort)
+{
+    for (int ii = 0; ii < MSP_DISPLAYPORT_CHARS; ii++) {
+        osdCharacterGridBuffer[ii] = ' ';
+    }
+    osdCharacterGridBufferClearAllDirty();
+
+    int ret = sendClearScreen(displayPort);
+    // Retry from drawScreen() if the TX buffer was full
+    clearPending = ret == 0;
+    return ret;
+}
+
+static int sendString(displayPort_t *displayPort, uint8_t col, uint8_t row, int len)
+{
+    uint8_t buf[MSP_DISPLAYPORT_COLS + 4];
+
+    buf[0] = 3;
+    buf[1] = row;
+    buf[2] = col;
+    buf[3] = 0;
+    const uint16_t *entry = osdCharacterGridBufferGetEntryPtr(col, row);
+    for (int ii = 0; ii < len; ii++) {
+        buf[4 + ii] = entry[ii];
+    }
+
+    return output(displayPort, MSP_DISPLAYPORT, buf, len + 4);
+}
+
 static int drawScreen(displayPort_t *displayPort)
 {
+    if (cliMode) {
+        return 0;
+    }
+
+    // Only the clear command is resent, characters written since
+    // clearScreen() are still dirty and get sent after it
+    if (clearPending) {
+        if (sendClearScreen(displayPort) == 0) {
+            return 0;
+        }
+        clearPending = false;
+    }
+
+    const timeMs_t now = millis();
+    if (now - refreshRowAt >= MSP_DISPLAYPORT_ROW_REFRESH_MS) {
+        for (int col = 0; col < MSP_DISPLAYPORT_COLS; col++) {
+            osdCharacterGridBufferSetDirty(refreshRow * MSP_DISPLAYPORT_COLS + col);
+        }
+        refreshRow = (refreshRow + 1) % MSP_DISPLAYPORT_ROWS;
+        refreshRowAt = now;
+    }
+
+    int written = 0;
+    int pos = 0;
+    unsigned spanLength;
+    while ((pos = osdCharacterGridBufferFindDirtySpan(pos, &spanLength)) >= 0) {
+        const int row = pos / MSP_DISPLAYPORT_COLS;
+        const int rowEnd = (row + 1) * MSP_DISPLAYPORT_COLS;
+        // Extend the string over the following spans in this row which
+        // are not too far from the previous one
+        int end = pos + spanLength;
+        for (int next = end; next < rowEnd && next - end <= MSP_DISPLAYPORT_MAX_GAP; next++) {
+            if (osdCharacterGridBufferIsDirty(next)) {
+                end = next + 1;
+            }
+        }
+
+        const int len = end - pos;
+        if (mspSerialTxBytesFree() < (uint32_t)(len + MSP_DISPLAYPORT_STRING_OVERHEAD)) {
+            break;
+        }
+        if (sendString(displayPort, pos - row * MSP_DISPLAYPORT_COLS, row, len) == 0) {
+            break;
+        }
+        written++;
+        for (; pos < end; pos++) {
+            osdCharacterGridBufferClearDirty(pos);
+        }
+    }
+
+    if (!written) {
+        return 0;
+    }
+
     uint8_t subcmd[] = { 4 };
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
 
+static void beginTransaction(displayPort_t *displayPort, displayTransactionOption_e opts)
+{
+    UNUSED(displayPort);
+    UNUSED(opts);
+
+    osdCharacterGridBufferBeginFrame();
+}
+
+static void commitTransaction(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+
+    osdCharacterGridBufferCommitFrame();
+}
+
 static int screenSize(const displayPort_t *displayPort)
 {
     return displayPort->rows * displayPort->cols;
@@ -95,22 +218,18 @@ static int screenSize(const displayPort_t *displayPort)
 
 static int writeString(displayPort_t *displayPort, uint8_t col, uint8_t row, const char *string, textAttributes_t attr)
 {
+    UNUSED(displayPort);
     UNUSED(attr);
-#define MSP_OSD_MAX_STRING_LENGTH 30 // FIXME move this
-    uint8_t buf[MSP_OSD_MAX_STRING_LENGTH + 4];
 
-    int len = strlen(string);
-    if (len >= MSP_OSD_MAX_STRING_LENGTH) {
-        len = MSP_OSD_MAX_STRING_LENGTH;
+    if (row >= MSP_DISPLAYPORT_ROWS) {
+        return 0;
     }
 
-    buf[0] = 3;
-    buf[1] = row;
-    buf[2] = col;
-    buf[3] = 0;
-    memcpy(&buf[4], string, len);
-
-    return output(displayPort, MSP_DISPLAYPORT, buf, len + 4);
+    int pos = row * MSP_DISPLAYPORT_COLS + col;
+    for (; *string && col < MSP_DISPLAYPORT_COLS; string++, col++, pos++) {
+        osdCharacterGridBufferWrite(pos, (uint8_t)*string);
+    }
+    return 0;
 }
 
 static int writeChar(displayPort_t *displayPort, uint8_t col, uint8_t row, uint16_t c, textAttributes_t attr)
@@ -128,10 +247,16 @@ static bool isTransferInProgress(const displayPort_t *displayPort)
     return false;
 }
 
+static bool hasPendingChanges(const displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return osdCharacterGridBufferHasDirty();
+}
+
 static void resync(displayPort_t *displayPort)
 {
-    displayPort->rows = 13;
-    displayPort->cols = 30;
+    displayPort->rows = MSP_DISPLAYPORT_ROWS;
+    displayPort->cols = MSP_DISPLAYPORT_COLS;
 }
 
 static uint32_t txBytesFree(const displayPort_t *displayPort)
@@ -150,10 +275,13 @@ static const displayPortVTable_t mspDisplayPortVTable = {
     .writeChar = writeChar,
     .readChar = NULL,
     .isTransferInProgress = isTransferInProgress,
+    .hasPendingChanges = hasPendingChanges,
     .heartbeat = heartbeat,
     .resync = resync,
     .txBytesFree = txBytesFree,
     .supportedTextAttributes = NULL,
+    .beginTransaction = beginTransaction,
+    .commitTransaction = commitTransaction,
 };
 
 displayPort_t *displayPortMspInit(void)
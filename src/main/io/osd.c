@@ -41,7 +41,9 @@
 #include "cms/cms_menu_osd.h"
 
 #include "common/axis.h"
+#include "common/bitarray.h"
 #include "common/constants.h"
+#include "common/crc.h"
 #include "common/filter.h"
 #include "common/log.h"
 #include "common/olc.h"
@@ -59,6 +61,7 @@
 #include "drivers/display_canvas.h"
 #include "drivers/display_font_metadata.h"
 #include "drivers/osd_symbols.h"
+#include "drivers/pwm_output.h"
 #include "drivers/time.h"
 #include "drivers/vtx_common.h"
 
@@ -137,6 +140,10 @@
 
 #define OSD_MIN_FONT_VERSION 1
 
+// Time spent drawing elements on each refresh, the AHI is not included.
+// At least one element is drawn per refresh regardless of the budget.
+#define OSD_ELEMENTS_DRAW_BUDGET_US 500
+
 static unsigned currentLayout = 0;
 static int layoutOverride = -1;
 static bool hasExtendedFont = false; // Wether the font supports characters > 256
@@ -174,6 +181,31 @@ static bool refreshWaitForResumeCmdRelease;
 
 static bool fullRedraw = false;
 
+typedef enum {
+    OSD_REFRESH_CLASS_FAST,     // Flight critical values
+    OSD_REFRESH_CLASS_NORMAL,
+    OSD_REFRESH_CLASS_SLOW,     // Labels and values which rarely change
+    OSD_REFRESH_CLASS_COUNT
+} osdRefreshClass_e;
+
+static const uint16_t osdRefreshClassIntervalMs[OSD_REFRESH_CLASS_COUNT] = {
+    [OSD_REFRESH_CLASS_FAST] = 50,
+    [OSD_REFRESH_CLASS_NORMAL] = 200,
+    [OSD_REFRESH_CLASS_SLOW] = 1000,
+};
+
+// Truncated to 16 bits, intervals are way below the wrap around
+static uint16_t osdElementDrawnAt[OSD_ITEM_COUNT];
+
+// Key of what each element showed when it was last drawn, either a hash
+// of its output or of the inputs it's formatted from. An element whose
+// key didn't change is not written to the display again. Keys expire
+// one element per refresh, so an element that was overwritten by
+// something else still gets repaired.
+static uint32_t osdElementCacheKey[OSD_ITEM_COUNT];
+static BITARRAY_DECLARE(osdElementCacheValid, OSD_ITEM_COUNT);
+static uint8_t osdElementCacheExpireIndex;
+
 static uint8_t armState;
 
 typedef struct osdMapData_s {
@@ -885,7 +917,7 @@ static void osdFormatThrottlePosition(char *buff, bool autoThr, textAttributes_t
     tfp_sprintf(buff + 2, "%3d", (constrain(thr, PWM_RANGE_MIN, PWM_RANGE_MAX) - PWM_RANGE_MIN) * 100 / (PWM_RANGE_MAX - PWM_RANGE_MIN));
 }
 
-#if defined(USE_ESC_SENSOR)
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_BIDIR)
 static void osdFormatRpm(char *buff, uint32_t rpm)
 {
     buff[0] = SYM_RPM;
@@ -903,8 +935,40 @@ static void osdFormatRpm(char *buff, uint32_t rpm)
         strcpy(buff + 1, "---");
     }
 }
+
+static uint32_t osdGetMotorRpm(void)
+{
+#ifdef USE_ESC_SENSOR
+    escSensorData_t * escSensor = escSensorGetData();
+    if (escSensor && escSensor->dataAge <= ESC_DATA_MAX_AGE) {
+        return escSensor->rpm;
+    }
+#endif
+#ifdef USE_DSHOT_BIDIR
+    // Average eRPM from the DSHOT replies, scaled like the ESC sensor RPM
+    const int motorCount = getMotorCount();
+    if (isMotorProtocolDshotBidirectional() && motorCount > 0) {
+        uint32_t erpm = 0;
+        for (int i = 0; i < motorCount; i++) {
+            erpm += pwmGetMotorERPM(i);
+        }
+        return erpm / motorCount / (motorConfig()->motorPoleCount / 2);
+    }
+#endif
+    return 0;
+}
 #endif
 
+static bool osdMotorRpmAvailable(void)
+{
+#ifdef USE_DSHOT_BIDIR
+    if (isMotorProtocolDshotBidirectional()) {
+        return true;
+    }
+#endif
+    return STATE(ESC_SENSOR_ENABLED);
+}
+
 int32_t osdGetAltitude(void)
 {
 #if defined(USE_NAV)
@@ -1264,6 +1328,28 @@ static void osdDisplayAdjustableDecimalValue(uint8_t elemPosX, uint8_t elemPosY,
     displayWriteWithAttr(osdDisplayPort, elemPosX + strlen(str) + 1 + valueOffset, elemPosY, buff, elemAttr);
 }
 
+static uint32_t osdElementInputKey(uint16_t pos, int32_t value)
+{
+    return (uint32_t)value * 2654435761U ^ pos;
+}
+
+static uint32_t osdElementOutputKey(uint16_t pos, const char *buff, textAttributes_t attr)
+{
+    return fnv1a_update_str(FNV1A_OFFSET_BASIS ^ pos ^ ((uint32_t)attr << 16), buff);
+}
+
+// Returns true if the element was drawn with the same key before,
+// otherwise stores the new key
+static bool osdElementIsUnchanged(uint8_t item, uint32_t key)
+{
+    if (bitArrayGet(osdElementCacheValid, item) && osdElementCacheKey[item] == key) {
+        return true;
+    }
+    osdElementCacheKey[item] = key;
+    bitArraySet(osdElementCacheValid, item);
+    return false;
+}
+
 static bool osdDrawSingleElement(uint8_t item)
 {
     uint16_t pos = osdConfig()->item_pos[currentLayout][item];
@@ -1273,12 +1359,17 @@ static bool osdDrawSingleElement(uint8_t item)
     uint8_t elemPosX = OSD_X(pos);
     uint8_t elemPosY = OSD_Y(pos);
     textAttributes_t elemAttr = TEXT_ATTRIBUTES_NONE;
+    bool keyedOnInput = false;
     char buff[32];
 
     switch (item) {
     case OSD_RSSI_VALUE:
         {
             uint16_t osdRssi = osdConvertRSSI();
+            if (osdElementIsUnchanged(item, osdElementInputKey(pos, osdRssi))) {
+                return true;
+            }
+            keyedOnInput = true;
             buff[0] = SYM_RSSI;
             tfp_sprintf(buff + 1, "%2d", osdRssi);
             if (osdRssi < osdConfig()->rssi_alarm) {
@@ -1355,6 +1446,10 @@ static bool osdDrawSingleElement(uint8_t item)
 
 #ifdef USE_GPS
     case OSD_GPS_SATS:
+        if (osdElementIsUnchanged(item, osdElementInputKey(pos, gpsSol.numSat | (STATE(GPS_FIX) ? 0x100 : 0)))) {
+            return true;
+        }
+        keyedOnInput = true;
         buff[0] = SYM_SAT_L;
         buff[1] = SYM_SAT_R;
         tfp_sprintf(buff + 2, "%2d", gpsSol.numSat);
@@ -1364,6 +1459,10 @@ static bool osdDrawSingleElement(uint8_t item)
         break;
 
     case OSD_GPS_SPEED:
+        if (osdElementIsUnchanged(item, osdElementInputKey(pos, gpsSol.groundSpeed))) {
+            return true;
+        }
+        keyedOnInput = true;
         osdFormatVelocityStr(buff, gpsSol.groundSpeed, false);
         break;
 
@@ -1422,6 +1521,10 @@ static bool osdDrawSingleElement(uint8_t item)
 
     case OSD_HOME_DIST:
         {
+            if (osdElementIsUnchanged(item, osdElementInputKey(pos, GPS_distanceToHome))) {
+                return true;
+            }
+            keyedOnInput = true;
             buff[0] = SYM_HOME;
             osdFormatDistanceSymbol(&buff[1], GPS_distanceToHome * 100);
             uint16_t dist_alarm = osdConfig()->dist_alarm;
@@ -1438,9 +1541,15 @@ static bool osdDrawSingleElement(uint8_t item)
 
     case OSD_HEADING:
         {
+            const bool headingValid = osdIsHeadingValid();
+            int16_t h = headingValid ? DECIDEGREES_TO_DEGREES(osdGetHeading()) : 0;
+            // Headings can be negative, keep the valid flag out of the value bits
+            if (osdElementIsUnchanged(item, osdElementInputKey(pos, (uint16_t)h | (headingValid ? 0x10000 : 0)))) {
+                return true;
+            }
+            keyedOnInput = true;
             buff[0] = SYM_HEADING;
-            if (osdIsHeadingValid()) {
-                int16_t h = DECIDEGREES_TO_DEGREES(osdGetHeading());
+            if (headingValid) {
                 if (h < 0) {
                     h += 360;
                 }
@@ -2451,25 +2560,24 @@ static bool osdDrawSingleElement(uint8_t item)
         }
 #endif
 
-#if defined(USE_ESC_SENSOR)
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_BIDIR)
     case OSD_ESC_RPM:
-        {
-            escSensorData_t * escSensor = escSensorGetData();
-            if (escSensor && escSensor->dataAge <= ESC_DATA_MAX_AGE) {
-                osdFormatRpm(buff, escSensor->rpm);
-            }
-            else {
-                osdFormatRpm(buff, 0);
-            }
-            break;
-        }
+        osdFormatRpm(buff, osdGetMotorRpm());
+        break;
 #endif
 
     default:
         return false;
     }
 
-    displayWriteWithAttr(osdDisplayPort, elemPosX, elemPosY, buff, elemAttr);
+    if (keyedOnInput || !osdElementIsUnchanged(item, osdElementOutputKey(pos, buff, elemAttr))) {
+        displayWriteWithAttr(osdDisplayPort, elemPosX, elemPosY, buff, elemAttr);
+    }
+    // Software blinking alternates between text and blanks on each write,
+    // so such elements must be drawn again on every refresh
+    if (displayAttributesRequireEmulation(osdDisplayPort, elemAttr)) {
+        bitArrayClr(osdElementCacheValid, item);
+    }
     return true;
 }
 
@@ -2533,7 +2641,7 @@ static uint8_t osdIncElementIndex(uint8_t elementIndex)
         }
     }
 
-    if (!STATE(ESC_SENSOR_ENABLED)) {
+    if (!osdMotorRpmAvailable()) {
         if (elementIndex == OSD_ESC_RPM) {
             elementIndex++;
         }
@@ -2545,14 +2653,102 @@ static uint8_t osdIncElementIndex(uint8_t elementIndex)
     return elementIndex;
 }
 
-void osdDrawNextElement(void)
+static osdRefreshClass_e osdElementRefreshClass(uint8_t item)
 {
-    static uint8_t elementIndex = 0;
+    switch (item) {
+    case OSD_RSSI_VALUE:
+    case OSD_MAIN_BATT_VOLTAGE:
+    case OSD_SAG_COMPENSATED_MAIN_BATT_VOLTAGE:
+    case OSD_THROTTLE_POS:
+    case OSD_THROTTLE_POS_AUTO_THR:
+    case OSD_CURRENT_DRAW:
+    case OSD_GPS_SPEED:
+    case OSD_3D_SPEED:
+    case OSD_AIR_SPEED:
+    case OSD_ALTITUDE:
+    case OSD_ALTITUDE_MSL:
+    case OSD_VARIO:
+    case OSD_VARIO_NUM:
+    case OSD_HEADING:
+    case OSD_HEADING_GRAPH:
+    case OSD_HOME_DIR:
+    case OSD_HOME_DIST:
+    case OSD_ATTITUDE_PITCH:
+    case OSD_ATTITUDE_ROLL:
+        return OSD_REFRESH_CLASS_FAST;
+    case OSD_CRAFT_NAME:
+    case OSD_VTX_CHANNEL:
+    case OSD_VTX_POWER:
+    case OSD_RTC_TIME:
+    case OSD_IMU_TEMPERATURE:
+    case OSD_BARO_TEMPERATURE:
+    case OSD_TEMP_SENSOR_0_TEMPERATURE:
+    case OSD_TEMP_SENSOR_1_TEMPERATURE:
+    case OSD_TEMP_SENSOR_2_TEMPERATURE:
+    case OSD_TEMP_SENSOR_3_TEMPERATURE:
+    case OSD_TEMP_SENSOR_4_TEMPERATURE:
+    case OSD_TEMP_SENSOR_5_TEMPERATURE:
+    case OSD_TEMP_SENSOR_6_TEMPERATURE:
+    case OSD_TEMP_SENSOR_7_TEMPERATURE:
+    case OSD_PLUS_CODE:
+    case OSD_MAP_SCALE:
+    case OSD_MAP_REFERENCE:
+        return OSD_REFRESH_CLASS_SLOW;
+    default:
+        return OSD_REFRESH_CLASS_NORMAL;
+    }
+}
+
+static void osdScheduleAllElements(void)
+{
+    // Make every element due on the next refresh
+    const uint16_t dueAt = millis() - osdRefreshClassIntervalMs[OSD_REFRESH_CLASS_SLOW];
+    for (int ii = 0; ii < OSD_ITEM_COUNT; ii++) {
+        osdElementDrawnAt[ii] = dueAt;
+    }
+    // The screen was cleared, elements must be written again
+    BITARRAY_CLR_ALL(osdElementCacheValid);
+}
+
+// Returns false when the drawing budget has been used up
+static bool osdDrawDueElements(osdRefreshClass_e refreshClass, uint16_t now, timeUs_t startTime)
+{
+    // One round robin position per class, so elements in the same
+    // class get a fair share when the budget runs out
+    static uint8_t elementIndex[OSD_REFRESH_CLASS_COUNT];
+    const uint16_t interval = osdRefreshClassIntervalMs[refreshClass];
     // Prevent infinite loop when no elements are enabled
-    uint8_t index = elementIndex;
+    const uint8_t index = elementIndex[refreshClass];
     do {
-        elementIndex = osdIncElementIndex(elementIndex);
-    } while(!osdDrawSingleElement(elementIndex) && index != elementIndex);
+        const uint8_t item = osdIncElementIndex(elementIndex[refreshClass]);
+        elementIndex[refreshClass] = item;
+        if (osdElementRefreshClass(item) != refreshClass || (uint16_t)(now - osdElementDrawnAt[item]) < interval) {
+            continue;
+        }
+        osdElementDrawnAt[item] = now;
+        if (osdDrawSingleElement(item) && cmpTimeUs(micros(), startTime) >= OSD_ELEMENTS_DRAW_BUDGET_US) {
+            return false;
+        }
+    } while (index != elementIndex[refreshClass]);
+    return true;
+}
+
+void osdDrawNextElement(void)
+{
+    const timeUs_t startTime = micros();
+    const uint16_t now = millis();
+
+    bitArrayClr(osdElementCacheValid, osdElementCacheExpireIndex);
+    if (++osdElementCacheExpireIndex == OSD_ITEM_COUNT) {
+        osdElementCacheExpireIndex = 0;
+    }
+
+    // Faster classes go first, so they get the budget when it's tight
+    for (int refreshClass = 0; refreshClass < OSD_REFRESH_CLASS_COUNT; refreshClass++) {
+        if (!osdDrawDueElements(refreshClass, now, startTime)) {
+            break;
+        }
+    }
 
     // Draw artificial horizon last
     osdDrawSingleElement(OSD_ARTIFICIAL_HORIZON);
@@ -2676,7 +2872,7 @@ void pgResetFn_osdConfig(osdConfig_t *osdConfig)
 
     osdConfig->item_pos[0][OSD_VTX_POWER] = OSD_POS(3, 5);
 
-#if defined(USE_ESC_SENSOR)
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_BIDIR)
     osdConfig->item_pos[0][OSD_ESC_RPM] = OSD_POS(1, 2);
 #endif
 
@@ -3090,6 +3286,7 @@ static void osdRefresh(timeUs_t currentTimeUs)
     if (IS_RC_MODE_ACTIVE(BOXOSD) && !(osdConfig()->osd_failsafe_switch_layout && FLIGHT_MODE(FAILSAFE_MODE))) {
 #endif
       displayClearScreen(osdDisplayPort);
+      osdScheduleAllElements();
       armState = ARMING_FLAG(ARMED);
       return;
     }
@@ -3119,6 +3316,7 @@ static void osdRefresh(timeUs_t currentTimeUs)
 
         if ((currentTimeUs > resumeRefreshAt) || ((!refreshWaitForResumeCmdRelease) && DELAYED_REFRESH_RESUME_COMMAND)) {
             displayClearScreen(osdDisplayPort);
+            osdScheduleAllElements();
             resumeRefreshAt = 0;
         } else {
             displayHeartbeat(osdDisplayPort);
@@ -3128,16 +3326,25 @@ static void osdRefresh(timeUs_t currentTimeUs)
 
 #ifdef USE_CMS
     if (!displayIsGrabbed(osdDisplayPort)) {
+        // Don't compose the next frame until the previous one reached the
+        // device, otherwise an element could be shown half old and half new
+        if (displayHasPendingChanges(osdDisplayPort)) {
+            displayDrawScreen(osdDisplayPort);
+            return;
+        }
         displayBeginTransaction(osdDisplayPort, DISPLAY_TRANSACTION_OPT_RESET_DRAWING);
         if (fullRedraw) {
             displayClearScreen(osdDisplayPort);
+            osdScheduleAllElements();
             fullRedraw = false;
         }
         osdDrawNextElement();
         displayHeartbeat(osdDisplayPort);
         displayCommitTransaction(osdDisplayPort);
-#ifdef OSD_CALLS_CMS
     } else {
+        // The display is cleared when released, draw everything again afterwards
+        fullRedraw = true;
+#ifdef OSD_CALLS_CMS
         cmsUpdate(currentTimeUs);
 #endif
     }
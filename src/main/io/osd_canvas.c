@@ -31,6 +31,7 @@
 #if defined(USE_CANVAS)
 
 #define AHI_MAX_DRAW_INTERVAL_MS 1000
+#define AHI_PIXELS_PER_DEGREE 3.5f
 
 #include "common/log.h"
 #include "common/maths.h"
@@ -156,12 +157,29 @@ static void osdDrawArtificialHorizonLevelLine(displayCanvas_t *canvas, int width
     displayCanvasStrokeLineToPoint(canvas, sz, yc + yoff);
 }
 
-static void osdDrawArtificialHorizonShapes(displayCanvas_t *canvas, float pitchAngle, float rollAngle, bool erase)
+static int osdArtificialHorizonBarWidth(const displayCanvas_t *canvas)
 {
-    int barWidth = (OSD_AHI_WIDTH - 1) * canvas->gridElementWidth;
+    return (OSD_AHI_WIDTH - 1) * canvas->gridElementWidth;
+}
+
+// Roll angle which moves the ends of the horizon bar by one pixel
+static float osdArtificialHorizonRollStep(const displayCanvas_t *canvas)
+{
+    return 2.0f / osdArtificialHorizonBarWidth(canvas);
+}
+
+// The AHI geometry is quantized to whole pixel steps: pitch in pixels of
+// vertical offset and roll in steps which move the horizon bar ends by
+// one pixel. Redraws happen only when it would actually change on screen,
+// and erasing with the previous quantized values strokes exactly the same
+// pixels that were drawn.
+static void osdDrawArtificialHorizonShapes(displayCanvas_t *canvas, int pitchPixels, int rollSteps, bool erase, bool drawBorder)
+{
+    int barWidth = osdArtificialHorizonBarWidth(canvas);
     int levelBarWidth = barWidth * (3.0/4);
     int crosshairMargin = 6;
-    float pixelsPerDegreeLevel = 3.5f;
+    float pixelsPerDegreeLevel = AHI_PIXELS_PER_DEGREE;
+    float rollAngle = rollSteps * osdArtificialHorizonRollStep(canvas);
     int maxWidth = (OSD_AHI_WIDTH + 1) * canvas->gridElementWidth;
     int maxHeight = OSD_AHI_HEIGHT * canvas->gridElementHeight;
     int borderSize = 3;
@@ -172,7 +190,8 @@ static void osdDrawArtificialHorizonShapes(displayCanvas_t *canvas, float pitchA
     int lx = (canvas->width - maxWidth) / 2;
     int ty = (canvas->height - maxHeight) / 2;
 
-    if (!erase) {
+    // The border doesn't move, it's only drawn on full redraws
+    if (drawBorder) {
         int rx = lx + maxWidth;
         int by = ty + maxHeight;
 
@@ -207,9 +226,9 @@ static void osdDrawArtificialHorizonShapes(displayCanvas_t *canvas, float pitchA
     }
 
     // The draw just the 5 bars closest to the current pitch level
-    float pitchDegrees = RADIANS_TO_DEGREES(pitchAngle);
+    float pitchDegrees = pitchPixels / pixelsPerDegreeLevel;
     float pitchCenter = roundf(pitchDegrees / 10.0f);
-    float pitchOffset = -pitchDegrees * pixelsPerDegreeLevel;
+    float pitchOffset = -pitchPixels;
     float translateX = canvas->width / 2;
     float translateY = canvas->height / 2;
 
@@ -269,21 +288,27 @@ void osdCanvasDrawArtificialHorizon(displayPort_t *display, displayCanvas_t *can
     UNUSED(display);
     UNUSED(p);
 
-    static float prevPitchAngle = 9999;
-    static float prevRollAngle = 9999;
+    static int prevPitchPixels = INT16_MAX;
+    static int prevRollSteps = INT16_MAX;
     static timeMs_t nextDrawMs = 0;
 
     timeMs_t now = millis();
 
-    if (fabsf(prevPitchAngle - pitchAngle) > 0.01f ||
-        fabsf(prevRollAngle - rollAngle) > 0.01f ||
-        now > nextDrawMs) {
+    int pitchPixels = lrintf(RADIANS_TO_DEGREES(pitchAngle) * AHI_PIXELS_PER_DEGREE);
+    int rollSteps = lrintf(rollAngle / osdArtificialHorizonRollStep(canvas));
+    bool fullRedraw = now > nextDrawMs;
+
+    if (pitchPixels != prevPitchPixels || rollSteps != prevRollSteps || fullRedraw) {
 
-        osdDrawArtificialHorizonShapes(canvas, prevPitchAngle, prevRollAngle, true);
-        osdDrawArtificialHorizonShapes(canvas, pitchAngle, rollAngle, false);
-        prevPitchAngle = pitchAngle;
-        prevRollAngle = rollAngle;
-        nextDrawMs = now + AHI_MAX_DRAW_INTERVAL_MS;
+        if (prevPitchPixels != INT16_MAX) {
+            osdDrawArtificialHorizonShapes(canvas, prevPitchPixels, prevRollSteps, true, false);
+        }
+        osdDrawArtificialHorizonShapes(canvas, pitchPixels, rollSteps, false, fullRedraw);
+        prevPitchPixels = pitchPixels;
+        prevRollSteps = rollSteps;
+        if (fullRedraw) {
+            nextDrawMs = now + AHI_MAX_DRAW_INTERVAL_MS;
+        }
     }
 }
 
@@ -65,3 +65,6 @@
 #define MSP2_SET_PID                            0x2031
 
 #define MSP2_INAV_OPFLOW_CALIBRATION            0x2032
+
+#define MSP2_INAV_TELEMETRY_SUBSCRIBE           0x2033  //in message    Replaces the port's push list (args: n x {cmd(u16), interval_ms(u16)}, empty to unsubscribe)
+#define MSP2_INAV_DATAFLASH_STREAM              0x2034  //in message    Streams MSP_DATAFLASH_READ replies (args: address(u32), length(u32), chunk size(u16, optional)), zero length stops
@@ -33,8 +33,12 @@
 
 #include "io/serial.h"
 #include "fc/cli.h"
+#include "fc/runtime_config.h"
+
+#include "io/flashfs.h"
 
 #include "msp/msp.h"
+#include "msp/msp_protocol.h"
 #include "msp/msp_serial.h"
 
 static mspPort_t mspPorts[MAX_MSP_PORT_COUNT];
@@ -266,21 +270,22 @@ static uint8_t mspSerialChecksumBuf(uint8_t checksum, const uint8_t *data, int l
 }
 
 #define JUMBO_FRAME_SIZE_LIMIT 255
-static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, const uint8_t * data, int dataLen, const uint8_t * crc, int crcLen)
+static bool mspSerialCanSendFrame(mspPort_t *msp, int totalFrameLength)
 {
     // VSP MSP port might be unconnected. To prevent blocking - check if it's connected first
     if (!serialIsConnected(msp->port)) {
-        return 0;
+        return false;
     }
 
     // We are allowed to send out the response if
     //  a) TX buffer is completely empty (we are talking to well-behaving party that follows request-response scheduling;
     //     this allows us to transmit jumbo frames bigger than TX buffer (serialWriteBuf will block, but for jumbo frames we don't care)
     //  b) Response fits into TX buffer
-    const int totalFrameLength = hdrLen + dataLen + crcLen;
-    if (!isSerialTransmitBufferEmpty(msp->port) && ((int)serialTxBytesFree(msp->port) < totalFrameLength))
-        return 0;
+    return isSerialTransmitBufferEmpty(msp->port) || ((int)serialTxBytesFree(msp->port) >= totalFrameLength);
+}
 
+static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, const uint8_t * data, int dataLen, const uint8_t * crc, int crcLen)
+{
     // Transmit frame
     serialBeginWrite(msp->port);
     serialWriteBuf(msp->port, hdr, hdrLen);
@@ -288,15 +293,17 @@ static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, c
     serialWriteBuf(msp->port, crc, crcLen);
     serialEndWrite(msp->port);
 
-    return totalFrameLength;
+    return hdrLen + dataLen + crcLen;
 }
 
 static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e mspVersion)
 {
     static const uint8_t mspMagic[MSP_VERSION_COUNT] = MSP_VERSION_MAGIC_INITIALIZER;
     const int dataLen = sbufBytesRemaining(&packet->buf);
+    const uint8_t * const data = sbufPtr(&packet->buf);
     uint8_t hdrBuf[16] = { '$', mspMagic[mspVersion], packet->result == MSP_RESULT_ERROR ? '!' : '>'};
     uint8_t crcBuf[2];
+    mspHeaderV2_t * hdrV2 = NULL;
     int hdrLen = 3;
     int crcLen = 0;
 
@@ -318,17 +325,14 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
             hdrV1->size = dataLen;
         }
 
-        // Pre-calculate CRC
-        crcBuf[crcLen] = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
-        crcBuf[crcLen] = mspSerialChecksumBuf(crcBuf[crcLen], sbufPtr(&packet->buf), dataLen);
-        crcLen++;
+        crcLen = 1;
     }
     else if (mspVersion == MSP_V2_OVER_V1) {
         mspHeaderV1_t * hdrV1 = (mspHeaderV1_t *)&hdrBuf[hdrLen];
 
         hdrLen += sizeof(mspHeaderV1_t);
 
-        mspHeaderV2_t * hdrV2 = (mspHeaderV2_t *)&hdrBuf[hdrLen];
+        hdrV2 = (mspHeaderV2_t *)&hdrBuf[hdrLen];
         hdrLen += sizeof(mspHeaderV2_t);
 
         const int v1PayloadSize = sizeof(mspHeaderV2_t) + dataLen + 1;  // MSPv2 header + data payload + MSPv2 checksum
@@ -351,36 +355,180 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
         hdrV2->cmd = packet->cmd;
         hdrV2->size = dataLen;
 
-        // V2 CRC: only V2 header + data payload
-        crcBuf[crcLen] = crc8_dvb_s2_update(0, (uint8_t *)hdrV2, sizeof(mspHeaderV2_t));
-        crcBuf[crcLen] = crc8_dvb_s2_update(crcBuf[crcLen], sbufPtr(&packet->buf), dataLen);
-        crcLen++;
-
-        // V1 CRC: All headers + data payload + V2 CRC byte
-        crcBuf[crcLen] = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
-        crcBuf[crcLen] = mspSerialChecksumBuf(crcBuf[crcLen], sbufPtr(&packet->buf), dataLen);
-        crcBuf[crcLen] = mspSerialChecksumBuf(crcBuf[crcLen], crcBuf, crcLen);
-        crcLen++;
+        crcLen = 2;
     }
     else if (mspVersion == MSP_V2_NATIVE) {
-        mspHeaderV2_t * hdrV2 = (mspHeaderV2_t *)&hdrBuf[hdrLen];
+        hdrV2 = (mspHeaderV2_t *)&hdrBuf[hdrLen];
         hdrLen += sizeof(mspHeaderV2_t);
 
         hdrV2->flags = packet->flags;
         hdrV2->cmd = packet->cmd;
         hdrV2->size = dataLen;
 
-        crcBuf[crcLen] = crc8_dvb_s2_update(0, (uint8_t *)hdrV2, sizeof(mspHeaderV2_t));
-        crcBuf[crcLen] = crc8_dvb_s2_update(crcBuf[crcLen], sbufPtr(&packet->buf), dataLen);
-        crcLen++;
+        crcLen = 1;
     }
     else {
         // Shouldn't get here
         return 0;
     }
 
+    // Don't waste time on checksumming the payload if the frame can't be sent anyway
+    if (!mspSerialCanSendFrame(msp, hdrLen + dataLen + crcLen)) {
+        return 0;
+    }
+
+    if (mspVersion == MSP_V1) {
+        crcBuf[0] = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
+        crcBuf[0] = mspSerialChecksumBuf(crcBuf[0], data, dataLen);
+    }
+    else {
+        // V2 CRC: only V2 header + data payload
+        crcBuf[0] = crc8_dvb_s2_update(0, (uint8_t *)hdrV2, sizeof(mspHeaderV2_t));
+        crcBuf[0] = crc8_dvb_s2_update(crcBuf[0], data, dataLen);
+
+        if (mspVersion == MSP_V2_OVER_V1) {
+            // V1 CRC: All headers + data payload + V2 CRC byte
+            crcBuf[1] = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
+            crcBuf[1] = mspSerialChecksumBuf(crcBuf[1], data, dataLen);
+            crcBuf[1] = mspSerialChecksumBuf(crcBuf[1], crcBuf, 1);
+        }
+    }
+
     // Send the frame
-    return mspSerialSendFrame(msp, hdrBuf, hdrLen, sbufPtr(&packet->buf), dataLen, crcBuf, crcLen);
+    return mspSerialSendFrame(msp, hdrBuf, hdrLen, data, dataLen, crcBuf, crcLen);
+}
+
+/*
+ * Subscriptions are a property of the port (the host which sent the request), so they are handled here
+ * and not in the FC command processor. The payload replaces the whole subscription list of the port.
+ */
+static mspResult_e mspSerialProcessSubscribeCommand(mspPort_t *msp, sbuf_t *src)
+{
+    const int dataSize = sbufBytesRemaining(src);
+
+    if ((dataSize % 4) != 0 || (dataSize / 4) > MSP_MAX_SUBSCRIPTIONS) {
+        return MSP_RESULT_ERROR;
+    }
+
+    const timeMs_t currentTimeMs = millis();
+
+    msp->subscriptionCount = 0;
+    msp->subscriptionIndex = 0;
+    msp->subscriptionVersion = msp->mspVersion;
+
+    while (sbufBytesRemaining(src) >= 4) {
+        const uint16_t subscribedCmd = sbufReadU16(src);
+        const uint16_t intervalMs = sbufReadU16(src);
+
+        // Zero interval disables the message
+        if (intervalMs == 0) {
+            continue;
+        }
+
+        mspSubscription_t *sub = &msp->subscriptions[msp->subscriptionCount++];
+        sub->cmd = subscribedCmd;
+        sub->intervalMs = MAX(intervalMs, MSP_SUBSCRIPTION_MIN_INTERVAL_MS);
+        sub->lastPushMs = currentTimeMs - sub->intervalMs;  // Push on first opportunity
+    }
+
+    return MSP_RESULT_ACK;
+}
+
+#ifdef USE_FLASHFS
+/*
+ * Returns the number of header and checksum bytes mspSerialEncode() adds to a reply of dataLen bytes
+ */
+static int mspSerialFrameOverhead(mspVersion_e mspVersion, int dataLen)
+{
+    switch (mspVersion) {
+    case MSP_V1:
+        return 3 + sizeof(mspHeaderV1_t) + (dataLen >= JUMBO_FRAME_SIZE_LIMIT ? sizeof(mspHeaderJUMBO_t) : 0) + 1;
+    case MSP_V2_OVER_V1:
+        {
+            const int v1PayloadSize = sizeof(mspHeaderV2_t) + dataLen + 1;
+            return 3 + sizeof(mspHeaderV1_t) + sizeof(mspHeaderV2_t) + (v1PayloadSize >= JUMBO_FRAME_SIZE_LIMIT ? sizeof(mspHeaderJUMBO_t) : 0) + 2;
+        }
+    case MSP_V2_NATIVE:
+        return 3 + sizeof(mspHeaderV2_t) + 1;
+    default:
+        return 0;
+    }
+}
+
+static mspResult_e mspSerialProcessDataflashStreamCommand(mspPort_t *msp, sbuf_t *src)
+{
+    mspDataflashStream_t *stream = &msp->dataflashStream;
+    uint32_t address;
+    uint32_t length;
+    uint16_t chunkSize;
+
+    // Request payload:
+    //  uint32_t    - address to start from
+    //  uint32_t    - number of bytes to stream, zero stops the stream
+    //  uint16_t    - chunk size (optional)
+    if (!sbufReadU32Safe(&address, src) || !sbufReadU32Safe(&length, src)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    if (!sbufReadU16Safe(&chunkSize, src) || chunkSize == 0) {
+        chunkSize = MSP_DATAFLASH_STREAM_DEFAULT_CHUNK;
+    }
+
+    // Streaming keeps the serial task busy for a while. Only allow it on the ground
+    if (length > 0 && ARMING_FLAG(ARMED)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    // Clamp the end of the stream to the flash size, so address + length can't wrap around
+    const uint32_t flashSize = flashfsGetSize();
+    address = MIN(address, flashSize);
+
+    stream->address = address;
+    stream->endAddress = address + MIN(length, flashSize - address);
+    stream->chunkSize = MIN(chunkSize, MSP_PORT_DATAFLASH_BUFFER_SIZE);
+    stream->version = msp->mspVersion;
+
+    // Chunks are only sent when the whole frame fits into the TX buffer, so on
+    // ports with a known buffer size (UARTs) a chunk can't be bigger than that
+    if (msp->port->txBufferSize > 0) {
+        const int frameOverhead = mspSerialFrameOverhead(stream->version, sizeof(uint32_t) + stream->chunkSize) + sizeof(uint32_t);
+        const int maxChunkSize = (int)msp->port->txBufferSize - 1 - frameOverhead;
+        stream->chunkSize = constrain(maxChunkSize, MSP_DATAFLASH_STREAM_MIN_CHUNK, stream->chunkSize);
+    }
+
+    return MSP_RESULT_ACK;
+}
+#endif
+
+/*
+ * Commands which change the state of the MSP port itself. Returns true if the command was handled
+ */
+static bool mspSerialProcessPortCommand(mspPort_t *msp, mspPacket_t *cmd, mspPacket_t *reply)
+{
+    mspResult_e ret;
+
+    switch (cmd->cmd) {
+    case MSP2_INAV_TELEMETRY_SUBSCRIBE:
+        ret = mspSerialProcessSubscribeCommand(msp, &cmd->buf);
+        break;
+
+#ifdef USE_FLASHFS
+    case MSP2_INAV_DATAFLASH_STREAM:
+        ret = mspSerialProcessDataflashStreamCommand(msp, &cmd->buf);
+        break;
+#endif
+
+    default:
+        return false;
+    }
+
+    if (cmd->flags & MSP_FLAG_DONT_REPLY) {
+        ret = MSP_RESULT_NO_REPLY;
+    }
+
+    reply->cmd = cmd->cmd;
+    reply->result = ret;
+    return true;
 }
 
 static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
@@ -403,7 +551,9 @@ static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspPr
     };
 
     mspPostProcessFnPtr mspPostProcessFn = NULL;
-    const mspResult_e status = mspProcessCommandFn(&command, &reply, &mspPostProcessFn);
+    const mspResult_e status = mspSerialProcessPortCommand(msp, &command, &reply) ?
+                                    reply.result :
+                                    mspProcessCommandFn(&command, &reply, &mspPostProcessFn);
 
     if (status != MSP_RESULT_NO_REPLY) {
         sbufSwitchToReader(&reply.buf, outBufHead); // change streambuf direction
@@ -452,6 +602,95 @@ static void mspProcessPendingRequest(mspPort_t * mspPort)
     }
 }
 
+#ifdef USE_FLASHFS
+/*
+ * Sends the next chunk of an active dataflash stream as a MSP_DATAFLASH_READ reply.
+ * Returns true if a chunk was sent and the stream has more data to send.
+ */
+static bool mspSerialProcessDataflashStreamChunk(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    mspDataflashStream_t *stream = &msp->dataflashStream;
+
+    if (!serialIsConnected(msp->port)) {
+        return false;
+    }
+
+    // Pace the stream by TX buffer space. Unlike request replies, chunks never rely on an empty
+    // TX buffer to send frames bigger than the free space, serialWriteBuf() would block until
+    // the whole frame went out. Overhead for the full chunk size covers any smaller chunk too.
+    const int frameOverhead = mspSerialFrameOverhead(stream->version, sizeof(uint32_t) + stream->chunkSize) + sizeof(uint32_t);
+    const int txSpace = (int)serialTxBytesFree(msp->port) - frameOverhead;
+    const int remaining = MIN(stream->chunkSize, stream->endAddress - stream->address);
+    if (txSpace < MIN(remaining, MSP_DATAFLASH_STREAM_MIN_CHUNK)) {
+        // Wait for room for a reasonable chunk instead of sending slivers
+        return false;
+    }
+    const uint16_t chunkSize = MIN(remaining, txSpace);
+
+    uint8_t requestBuf[sizeof(uint32_t) + sizeof(uint16_t)];
+    sbuf_t request = { .ptr = requestBuf, .end = ARRAYEND(requestBuf), };
+    sbufWriteU32(&request, stream->address);
+    sbufWriteU16(&request, chunkSize);
+
+    uint8_t outBuf[MSP_PORT_OUTBUF_SIZE];
+
+    mspPacket_t reply = {
+        .buf = { .ptr = outBuf, .end = ARRAYEND(outBuf), },
+        .cmd = -1,
+        .flags = 0,
+        .result = 0,
+    };
+    uint8_t *outBufHead = reply.buf.ptr;
+
+    mspPacket_t command = {
+        .buf = { .ptr = requestBuf, .end = ARRAYEND(requestBuf), },
+        .cmd = MSP_DATAFLASH_READ,
+        .flags = 0,
+        .result = 0,
+    };
+
+    const mspResult_e status = mspProcessCommandFn(&command, &reply, NULL);
+    const int bytesRead = (reply.buf.ptr - outBufHead) - (int)sizeof(uint32_t);
+
+    sbufSwitchToReader(&reply.buf, outBufHead);
+
+    // Keep the address if the reply didn't go out, the same chunk is read again on the next run
+    if (mspSerialEncode(msp, &reply, stream->version) <= 0) {
+        return false;
+    }
+
+    // Reply with no data marks the end of the volume, the host sees it as the last chunk
+    if (status != MSP_RESULT_ACK || bytesRead <= 0) {
+        stream->endAddress = stream->address;
+        return false;
+    }
+
+    stream->address += bytesRead;
+    return stream->address < stream->endAddress;
+}
+
+static void mspSerialProcessDataflashStream(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    if (msp->dataflashStream.address >= msp->dataflashStream.endAddress) {
+        return;
+    }
+
+    // Abort the stream if the craft has been armed meanwhile
+    if (ARMING_FLAG(ARMED)) {
+        msp->dataflashStream.endAddress = msp->dataflashStream.address;
+        return;
+    }
+
+    // Send as many chunks as the link takes within the time budget
+    const timeUs_t startTime = micros();
+    while (mspSerialProcessDataflashStreamChunk(msp, mspProcessCommandFn)) {
+        if (cmpTimeUs(micros(), startTime) >= MSP_DATAFLASH_STREAM_TIME_BUDGET_US) {
+            break;
+        }
+    }
+}
+#endif
+
 /*
  * Process MSP commands from serial ports configured as MSP ports.
  *
@@ -495,6 +734,87 @@ void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessComm
         else {
             mspProcessPendingRequest(mspPort);
         }
+
+#ifdef USE_FLASHFS
+        // Port might have been taken over by CLI
+        if (mspPort->port && mspPort->c_state == MSP_IDLE) {
+            mspSerialProcessDataflashStream(mspPort, mspProcessCommandFn);
+        }
+#endif
+    }
+}
+
+static bool mspSerialPushSubscription(mspPort_t *msp, mspSubscription_t *sub, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    uint8_t outBuf[MSP_PORT_OUTBUF_SIZE];
+
+    mspPacket_t reply = {
+        .buf = { .ptr = outBuf, .end = ARRAYEND(outBuf), },
+        .cmd = -1,
+        .flags = 0,
+        .result = 0,
+    };
+    uint8_t *outBufHead = reply.buf.ptr;
+
+    // Subscribed messages are always requested without payload
+    mspPacket_t command = {
+        .buf = { .ptr = msp->inBuf, .end = msp->inBuf, },
+        .cmd = sub->cmd,
+        .flags = 0,
+        .result = 0,
+    };
+
+    if (mspProcessCommandFn(&command, &reply, NULL) != MSP_RESULT_ACK) {
+        // Not a pushable message - drop it from the list
+        sub->intervalMs = 0;
+        return true;
+    }
+
+    sbufSwitchToReader(&reply.buf, outBufHead);
+    return mspSerialEncode(msp, &reply, msp->subscriptionVersion) > 0;
+}
+
+static void mspSerialProcessPortSubscriptions(mspPort_t *msp, timeMs_t currentTimeMs, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    for (int i = 0; i < msp->subscriptionCount; i++) {
+        const int index = (msp->subscriptionIndex + i) % msp->subscriptionCount;
+        mspSubscription_t *sub = &msp->subscriptions[index];
+
+        if (sub->intervalMs == 0 || (currentTimeMs - sub->lastPushMs) < sub->intervalMs) {
+            continue;
+        }
+
+        if (!mspSerialPushSubscription(msp, sub, mspProcessCommandFn)) {
+            // TX buffer is full. Retry on next run, starting with this message
+            msp->subscriptionIndex = index;
+            return;
+        }
+
+        // Keep the rate steady, but don't try to catch up if we've fallen behind by more than one interval
+        sub->lastPushMs += sub->intervalMs;
+        if ((currentTimeMs - sub->lastPushMs) >= sub->intervalMs) {
+            sub->lastPushMs = currentTimeMs;
+        }
+    }
+}
+
+/*
+ * Push subscribed messages to the ports which requested them via MSP2_INAV_TELEMETRY_SUBSCRIBE.
+ * Messages are only pushed when they fit into the TX buffer, so replies to regular requests are not delayed.
+ *
+ * Called periodically by the scheduler.
+ */
+void mspSerialProcessSubscriptions(timeMs_t currentTimeMs, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    for (uint8_t portIndex = 0; portIndex < MAX_MSP_PORT_COUNT; portIndex++) {
+        mspPort_t * const mspPort = &mspPorts[portIndex];
+
+        // Don't interleave with a request which is being received
+        if (!mspPort->port || mspPort->subscriptionCount == 0 || mspPort->c_state != MSP_IDLE) {
+            continue;
+        }
+
+        mspSerialProcessPortSubscriptions(mspPort, currentTimeMs, mspProcessCommandFn);
     }
 }
 
@@ -506,18 +826,13 @@ void mspSerialInit(void)
 
 int mspSerialPushPort(uint16_t cmd, const uint8_t *data, int datalen, mspPort_t *mspPort, mspVersion_e version)
 {
-    uint8_t pushBuf[MSP_PORT_OUTBUF_SIZE];
-
+    // Encode straight from caller's buffer. The encoder only reads the payload, no need for a stack copy
     mspPacket_t push = {
-        .buf = { .ptr = pushBuf, .end = ARRAYEND(pushBuf), },
+        .buf = { .ptr = (uint8_t *)data, .end = (uint8_t *)data + datalen, },
         .cmd = cmd,
         .result = 0,
     };
 
-    sbufWriteData(&push.buf, data, datalen);
-
-    sbufSwitchToReader(&push.buf, pushBuf);
-
     return mspSerialEncode(mspPort, &push, version);
 }
 
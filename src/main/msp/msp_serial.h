@@ -81,6 +81,30 @@ typedef struct __attribute__((packed)) {
 
 #define MSP_MAX_HEADER_SIZE     9
 
+// Telemetry subscriptions: messages pushed periodically without a request from the host
+#define MSP_MAX_SUBSCRIPTIONS               8
+#define MSP_SUBSCRIPTION_MIN_INTERVAL_MS    10      // Serial task runs at 100Hz, no point in pushing faster
+
+typedef struct mspSubscription_s {
+    uint16_t cmd;
+    uint16_t intervalMs;
+    timeMs_t lastPushMs;
+} mspSubscription_t;
+
+#ifdef USE_FLASHFS
+// Dataflash streaming: consecutive MSP_DATAFLASH_READ replies pushed without a request per chunk
+#define MSP_DATAFLASH_STREAM_DEFAULT_CHUNK  1024    // Capped to the TX buffer of the port
+#define MSP_DATAFLASH_STREAM_MIN_CHUNK      64
+#define MSP_DATAFLASH_STREAM_TIME_BUDGET_US 2000    // Keep streaming within one serial task run while under this time
+
+typedef struct mspDataflashStream_s {
+    uint32_t address;           // Next address to send
+    uint32_t endAddress;        // Stream is active while address < endAddress
+    uint16_t chunkSize;
+    mspVersion_e version;
+} mspDataflashStream_t;
+#endif
+
 struct serialPort_s;
 typedef struct mspPort_s {
     struct serialPort_s *port; // null when port unused.
@@ -95,11 +119,19 @@ typedef struct mspPort_s {
     uint16_t cmdMSP;
     uint8_t checksum1;
     uint8_t checksum2;
+    mspVersion_e subscriptionVersion;
+    uint8_t subscriptionCount;
+    uint8_t subscriptionIndex;          // round-robin start, so a full TX buffer doesn't starve the last subscriptions
+    mspSubscription_t subscriptions[MSP_MAX_SUBSCRIPTIONS];
+#ifdef USE_FLASHFS
+    mspDataflashStream_t dataflashStream;
+#endif
 } mspPort_t;
 
 
 void mspSerialInit(void);
 void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn);
+void mspSerialProcessSubscriptions(timeMs_t currentTimeMs, mspProcessCommandFnPtr mspProcessCommandFn);
 void mspSerialAllocatePorts(void);
 void mspSerialReleasePortIfAllocated(struct serialPort_s *serialPort);
 int mspSerialPushPort(uint16_t cmd, const uint8_t *data, int datalen, mspPort_t *mspPort, mspVersion_e version);
@@ -0,0 +1,104 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_MSP_STATISTICS
+
+#include "msp/msp_stats.h"
+
+// Kept sorted by command ID, so lookups are a binary search
+static mspCommandStats_t mspCommandStats[MSP_STATS_MAX_COMMANDS];
+static int mspCommandStatsCount;
+static uint32_t mspUntrackedCallCount;     // Calls to commands which didn't fit into the table
+
+static int mspStatsFindIndex(uint16_t cmd)
+{
+    int low = 0;
+    int high = mspCommandStatsCount;
+
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (mspCommandStats[mid].cmd < cmd) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+void mspStatsRecord(uint16_t cmd, timeUs_t executionTime)
+{
+    const int index = mspStatsFindIndex(cmd);
+    mspCommandStats_t *stats = &mspCommandStats[index];
+
+    if (index >= mspCommandStatsCount || stats->cmd != cmd) {
+        if (mspCommandStatsCount >= MSP_STATS_MAX_COMMANDS) {
+            mspUntrackedCallCount++;
+            return;
+        }
+
+        memmove(stats + 1, stats, (mspCommandStatsCount - index) * sizeof(mspCommandStats_t));
+        memset(stats, 0, sizeof(mspCommandStats_t));
+        stats->cmd = cmd;
+        mspCommandStatsCount++;
+    }
+
+    stats->callCount++;
+    stats->totalExecutionTime += executionTime;
+    if (executionTime > stats->maxExecutionTime) {
+        stats->maxExecutionTime = executionTime;
+    }
+}
+
+void mspStatsReset(void)
+{
+    memset(mspCommandStats, 0, sizeof(mspCommandStats));
+    mspCommandStatsCount = 0;
+    mspUntrackedCallCount = 0;
+}
+
+int mspStatsCommandCount(void)
+{
+    return mspCommandStatsCount;
+}
+
+const mspCommandStats_t * mspStatsGetCommand(int index)
+{
+    return &mspCommandStats[index];
+}
+
+uint32_t mspStatsUntrackedCount(void)
+{
+    return mspUntrackedCallCount;
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/time.h"
+
+#define MSP_STATS_MAX_COMMANDS  32
+
+typedef struct mspCommandStats_s {
+    uint16_t cmd;
+    uint32_t callCount;
+    timeUs_t maxExecutionTime;
+    timeUs_t totalExecutionTime;
+} mspCommandStats_t;
+
+void mspStatsRecord(uint16_t cmd, timeUs_t executionTime);
+void mspStatsReset(void);
+int mspStatsCommandCount(void);
+const mspCommandStats_t * mspStatsGetCommand(int index);
+uint32_t mspStatsUntrackedCount(void);
@@ -39,6 +39,7 @@
 #include "fc/config.h"
 
 #include "flight/imu.h"
+#include "flight/imu_ekf.h"
 
 #include "io/gps.h"
 
@@ -279,6 +280,20 @@ void onNewGPSData(void)
 
                 /* Indicate a last valid reading of Pos/Vel */
                 posEstimator.gps.lastUpdateTime = currentTimeUs;
+
+#if defined(USE_IMU_EKF)
+                /* GPS altitude is only used by EKF if there is no baro, same as below */
+                imuEkfUpdateGps(&posEstimator.gps.pos, &posEstimator.gps.vel, posEstimator.gps.eph, posEstimator.gps.epv, !sensors(SENSOR_BARO), ARMING_FLAG(ARMED));
+
+                /* On a plane sideslip and airspeed make the wind observable */
+                if (STATE(FIXED_WING) && ARMING_FLAG(ARMED)) {
+#if defined(USE_PITOT)
+                    imuEkfUpdateAirData(sensors(SENSOR_PITOT) ? &posEstimator.pitot.airspeed : NULL);
+#else
+                    imuEkfUpdateAirData(NULL);
+#endif
+                }
+#endif
             }
 
             previousLat = gpsSol.llh.lat;
@@ -317,6 +332,10 @@ void updatePositionEstimator_BaroTopic(timeUs_t currentTimeUs)
         posEstimator.baro.epv = positionEstimationConfig()->baro_epv;
         posEstimator.baro.lastUpdateTime = currentTimeUs;
 
+#if defined(USE_IMU_EKF)
+        imuEkfUpdateBaro(posEstimator.baro.alt, posEstimator.baro.epv, ARMING_FLAG(ARMED));
+#endif
+
         if (baroDtUs <= MS2US(INAV_BARO_TIMEOUT_MS)) {
             pt1FilterApply3(&posEstimator.baro.avgFilter, posEstimator.baro.alt, US2S(baroDtUs));
         }
@@ -342,7 +361,7 @@ void updatePositionEstimator_PitotTopic(timeUs_t currentTimeUs)
 
 /**
  * Update IMU topic
- *  Function is called at main loop rate
+ *  Function is called at estimator rate
  */
 static void restartGravityCalibration(void)
 {
@@ -660,7 +679,7 @@ static bool estimationCalculateCorrection_XY_GPS(estimationContext_t * ctx)
 
 /**
  * Calculate next estimate using IMU and apply corrections from reference sensors (GPS, BARO etc)
- *  Function is called at main loop rate
+ *  Function is called at estimator rate
  */
 static void updateEstimatedTopic(timeUs_t currentTimeUs)
 {
@@ -730,6 +749,13 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
         }
     }
 
+#if defined(USE_IMU_EKF)
+    /* EKF solution replaces the estimate when EKF is the selected estimator */
+    if (imuConfig()->ahrs_type == AHRS_TYPE_EKF) {
+        imuEkfGetNavState(&posEstimator.est.pos, &posEstimator.est.vel, &ctx.newEPH, &ctx.newEPV);
+    }
+#endif
+
     /* Update uncertainty */
     posEstimator.est.eph = ctx.newEPH;
     posEstimator.est.epv = ctx.newEPV;
@@ -740,7 +766,7 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
 
 /**
  * Examine estimation error and update navigation system if estimate is good enough
- *  Function is called at main loop rate, but updates happen less frequently - at a fixed rate
+ *  Function is called at estimator rate, but updates happen less frequently - at a fixed rate
  */
 static void publishEstimatedTopic(timeUs_t currentTimeUs)
 {
@@ -821,7 +847,7 @@ void initializePositionEstimator(void)
 
 /**
  * Update estimator
- *  Update rate: loop rate (>100Hz)
+ *  Update rate: TASK_POS_ESTIMATOR rate (250Hz)
  */
 void FAST_CODE NOINLINE updatePositionEstimator(void)
 {
@@ -52,6 +52,9 @@ typedef enum {
     /* Actual tasks */
     TASK_SYSTEM = 0,
     TASK_GYROPID,
+#ifdef USE_NAV
+    TASK_POS_ESTIMATOR,
+#endif
     TASK_RX,
     TASK_SERIAL,
     TASK_BATTERY,
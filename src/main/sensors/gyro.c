@@ -99,6 +99,13 @@ STATIC_FASTRAM filterApplyFnPtr gyroFilterStage2ApplyFn;
 STATIC_FASTRAM void *stage2Filter[XYZ_AXIS_COUNT];
 #endif
 
+// Shortest gyro sampling interval the MCU can read and filter in time when pid_process_denom > 1
+#if defined(STM32F3)
+#define GYRO_MIN_LOOPTIME_US    250
+#else
+#define GYRO_MIN_LOOPTIME_US    125
+#endif
+
 #ifdef USE_DYNAMIC_FILTERS
 
 #define DYNAMIC_NOTCH_DEFAULT_CENTER_HZ 350
@@ -111,7 +118,7 @@ static EXTENDED_FASTRAM biquadFilter_t notchFilterDyn2[XYZ_AXIS_COUNT];
 EXTENDED_FASTRAM gyroAnalyseState_t gyroAnalyseState;
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 6);
+PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 7);
 
 PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .gyro_lpf = GYRO_LPF_42HZ,      // 42HZ value is defined for Invensense/TDK gyros
@@ -120,6 +127,7 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .gyro_align = ALIGN_DEFAULT,
     .gyroMovementCalibrationThreshold = 32,
     .looptime = 1000,
+    .pidProcessDenom = 1,
     .gyroSync = 1,
     .gyro_to_use = 0,
     .gyro_soft_notch_hz_1 = 0,
@@ -289,8 +297,8 @@ static void gyroInitFilterDynamicNotch(void)
         }
         const float notchQ = filterGetNotchQ(DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, DYNAMIC_NOTCH_DEFAULT_CUTOFF_HZ); // any defaults OK here
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&notchFilterDyn[axis], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, getLooptime(), notchQ, FILTER_NOTCH);
-            biquadFilterInit(&notchFilterDyn2[axis], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, getLooptime(), notchQ, FILTER_NOTCH);
+            biquadFilterInit(&notchFilterDyn[axis], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, gyro.targetLooptime, notchQ, FILTER_NOTCH);
+            biquadFilterInit(&notchFilterDyn2[axis], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, gyro.targetLooptime, notchQ, FILTER_NOTCH);
         }
     }
 
@@ -312,14 +320,37 @@ bool gyroInit(void)
         return false;
     }
 
+    // looptime is the PID loop interval, the gyro is sampled and filtered pidProcessDenom times faster.
+    // Reduce the denominator if the resulting gyro rate is more than the MCU can handle
+    uint8_t pidProcessDenom = MAX(gyroConfig()->pidProcessDenom, 1);
+    while (pidProcessDenom > 1 && gyroConfig()->looptime / pidProcessDenom < GYRO_MIN_LOOPTIME_US) {
+        pidProcessDenom--;
+    }
+    uint32_t gyroLooptime = gyroConfig()->looptime / pidProcessDenom;
+
     // Driver initialisation
     gyroDev0.lpf = gyroConfig()->gyro_lpf;
-    gyroDev0.requestedSampleIntervalUs = gyroConfig()->looptime;
-    gyroDev0.sampleRateIntervalUs = gyroConfig()->looptime;
+    gyroDev0.requestedSampleIntervalUs = gyroLooptime;
+    gyroDev0.sampleRateIntervalUs = gyroLooptime;
     gyroDev0.initFn(&gyroDev0);
 
+    // The sensor may not support the requested rate. With gyro_sync the gyro loop runs at the sensor
+    // rate, so pick the denominator which gets the PID loop closest to looptime. Otherwise never filter
+    // faster than the sensor delivers new samples. The resulting PID looptime is reported by getLooptime()
+    const uint32_t sampleIntervalUs = gyroDev0.sampleRateIntervalUs;
+    if (sampleIntervalUs > 0 && gyroConfig()->looptime > 0 && sampleIntervalUs != gyroLooptime) {
+        if (gyroConfig()->gyroSync) {
+            pidProcessDenom = MAX((gyroConfig()->looptime + sampleIntervalUs / 2) / sampleIntervalUs, 1U);
+            gyroLooptime = sampleIntervalUs;
+        } else if (pidProcessDenom > 1 && sampleIntervalUs > gyroLooptime) {
+            pidProcessDenom = MAX(gyroConfig()->looptime / sampleIntervalUs, 1U);
+            gyroLooptime = gyroConfig()->looptime / pidProcessDenom;
+        }
+    }
+
     // initFn will initialize sampleRateIntervalUs to actual gyro sampling rate (if driver supports it). Calculate target looptime using that value
-    gyro.targetLooptime = gyroConfig()->gyroSync ? gyroDev0.sampleRateIntervalUs : gyroConfig()->looptime;
+    gyro.targetLooptime = gyroConfig()->gyroSync ? sampleIntervalUs : gyroLooptime;
+    gyro.pidProcessDenom = pidProcessDenom;
 
     if (gyroConfig()->gyro_align != ALIGN_DEFAULT) {
         gyroDev0.gyroAlign = gyroConfig()->gyro_align;
@@ -328,7 +359,7 @@ bool gyroInit(void)
     gyroInitFilters();
 #ifdef USE_DYNAMIC_FILTERS
     gyroInitFilterDynamicNotch();
-    gyroDataAnalyseStateInit(&gyroAnalyseState, getLooptime());
+    gyroDataAnalyseStateInit(&gyroAnalyseState, gyro.targetLooptime);
 #endif
     return true;
 }
@@ -354,7 +385,7 @@ void gyroInitFilters(void)
         gyroFilterStage2ApplyFn = (filterApplyFnPtr)biquadFilterApply;
         for (int axis = 0; axis < 3; axis++) {
             stage2Filter[axis] = &gyroFilterStage2[axis];
-            biquadRCFIR2FilterInit(stage2Filter[axis], gyroConfig()->gyro_stage2_lowpass_hz, getLooptime());
+            biquadRCFIR2FilterInit(stage2Filter[axis], gyroConfig()->gyro_stage2_lowpass_hz, gyro.targetLooptime);
         }
     }
 #endif
@@ -367,14 +398,14 @@ void gyroInitFilters(void)
             softLpfFilterApplyFn = (filterApplyFnPtr)pt1FilterApply;
             for (int axis = 0; axis < 3; axis++) {
                 softLpfFilter[axis] = &gyroFilterLPF[axis].pt1;
-                pt1FilterInit(softLpfFilter[axis], gyroConfig()->gyro_soft_lpf_hz, getLooptime()* 1e-6f);
+                pt1FilterInit(softLpfFilter[axis], gyroConfig()->gyro_soft_lpf_hz, gyro.targetLooptime* 1e-6f);
             }
             break;
         case FILTER_BIQUAD:
             softLpfFilterApplyFn = (filterApplyFnPtr)biquadFilterApply;
             for (int axis = 0; axis < 3; axis++) {
                 softLpfFilter[axis] = &gyroFilterLPF[axis].biquad;
-                biquadFilterInitLPF(softLpfFilter[axis], gyroConfig()->gyro_soft_lpf_hz, getLooptime());
+                biquadFilterInitLPF(softLpfFilter[axis], gyroConfig()->gyro_soft_lpf_hz, gyro.targetLooptime);
             }
             break;
         }
@@ -385,7 +416,7 @@ void gyroInitFilters(void)
         notchFilter1ApplyFn = (filterApplyFnPtr)biquadFilterApply;
         for (int axis = 0; axis < 3; axis++) {
             notchFilter1[axis] = &gyroFilterNotch_1[axis];
-            biquadFilterInitNotch(notchFilter1[axis], getLooptime(), gyroConfig()->gyro_soft_notch_hz_1, gyroConfig()->gyro_soft_notch_cutoff_1);
+            biquadFilterInitNotch(notchFilter1[axis], gyro.targetLooptime, gyroConfig()->gyro_soft_notch_hz_1, gyroConfig()->gyro_soft_notch_cutoff_1);
         }
     }
 #endif
@@ -395,7 +426,7 @@ void gyroInitFilters(void)
         notchFilter2ApplyFn = (filterApplyFnPtr)biquadFilterApply;
         for (int axis = 0; axis < 3; axis++) {
             notchFilter2[axis] = &gyroFilterNotch_2[axis];
-            biquadFilterInitNotch(notchFilter2[axis], getLooptime(), gyroConfig()->gyro_soft_notch_hz_2, gyroConfig()->gyro_soft_notch_cutoff_2);
+            biquadFilterInitNotch(notchFilter2[axis], gyro.targetLooptime, gyroConfig()->gyro_soft_notch_hz_2, gyroConfig()->gyro_soft_notch_cutoff_2);
         }
     }
 #endif
@@ -552,10 +583,11 @@ int16_t gyroRateDps(int axis)
     return lrintf(gyro.gyroADCf[axis] / gyroDev0.scale);
 }
 
-bool gyroSyncCheckUpdate(void)
+bool gyroSyncCheckUpdate(timeUs_t *sampleTimeUs)
 {
-    if (!gyroDev0.intStatusFn)
+    if (!gyroDev0.intStatusFn || !gyroDev0.intStatusFn(&gyroDev0))
         return false;
 
-    return gyroDev0.intStatusFn(&gyroDev0);
+    *sampleTimeUs = gyroDev0.dataReadyTimeUs;
+    return true;
 }
@@ -50,7 +50,8 @@ typedef enum {
 #define DYN_NOTCH_RANGE_HZ_LOW 1000
 
 typedef struct gyro_s {
-    uint32_t targetLooptime;
+    uint32_t targetLooptime;                // Gyro sampling and filtering interval
+    uint8_t pidProcessDenom;                // PID loop runs once every pidProcessDenom gyro updates
     float gyroADCf[XYZ_AXIS_COUNT];
 } gyro_t;
 
@@ -61,6 +62,7 @@ typedef struct gyroConfig_s {
     uint8_t  gyroMovementCalibrationThreshold; // people keep forgetting that moving model while init results in wrong gyro offsets. and then they never reset gyro. so this is now on by default.
     uint8_t  gyroSync;                      // Enable interrupt based loop
     uint16_t looptime;                      // imu loop time in us
+    uint8_t  pidProcessDenom;               // Gyro is sampled and filtered this many times per looptime
     uint8_t  gyro_lpf;                      // gyro LPF setting - values are driver specific, in case of invalid number, a reasonable default ~30-40HZ is chosen.
     uint8_t  gyro_soft_lpf_hz;
     uint8_t  gyro_soft_lpf_type;
@@ -87,4 +89,4 @@ bool gyroIsCalibrationComplete(void);
 bool gyroReadTemperature(void);
 int16_t gyroGetTemperature(void);
 int16_t gyroRateDps(int axis);
-bool gyroSyncCheckUpdate(void);
+bool gyroSyncCheckUpdate(timeUs_t *sampleTimeUs);
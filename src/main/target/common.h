@@ -70,6 +70,7 @@
 
 #if (FLASH_SIZE > 256)
 #define USE_DYNAMIC_FILTERS
+#define USE_IMU_EKF
 #define USE_EXTENDED_CMS_MENUS
 #define USE_UAV_INTERCONNECT
 #define USE_RX_UIB
@@ -114,6 +115,8 @@
 
 #define NAV_AUTO_MAG_DECLINATION_PRECISE
 
+#define USE_MSP_STATISTICS
+
 #define USE_D_BOOST
 #define USE_ANTIGRAVITY
 
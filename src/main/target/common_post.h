@@ -48,6 +48,12 @@
 #define NOINLINE
 #endif
 
+#if defined(USE_DSHOT) && defined(STM32F4)
+// Bidirectional DShot switches the motor timer channels to input capture,
+// only implemented for the StdPeriph timer driver on F4
+#define USE_DSHOT_BIDIR
+#endif
+
 #ifdef STM32F3
 #undef USE_WIND_ESTIMATOR
 #undef USE_SERIALRX_SUMD
@@ -0,0 +1,80 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/crc.h"
+    #include "common/streambuf.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Bitwise CRC8 DVB-S2 (polynomial 0xD5) the lookup table was generated from
+static uint8_t crc8DvbS2Reference(uint8_t crc, unsigned char a)
+{
+    crc ^= a;
+    for (int ii = 0; ii < 8; ++ii) {
+        if (crc & 0x80) {
+            crc = (crc << 1) ^ 0xD5;
+        } else {
+            crc = crc << 1;
+        }
+    }
+    return crc;
+}
+
+TEST(CrcTest, Crc8DvbS2MatchesBitwise)
+{
+    for (int crc = 0; crc < 256; crc++) {
+        for (int a = 0; a < 256; a++) {
+            EXPECT_EQ(crc8DvbS2Reference(crc, a), crc8_dvb_s2(crc, a)) << "crc " << crc << " byte " << a;
+        }
+    }
+}
+
+TEST(CrcTest, Crc8DvbS2CheckValue)
+{
+    const char *check = "123456789";
+
+    EXPECT_EQ(0xBC, crc8_dvb_s2_update(0, check, strlen(check)));
+    EXPECT_EQ(0x00, crc8_dvb_s2_update(0, check, 0));
+}
+
+TEST(CrcTest, Crc8DvbS2SbufAppend)
+{
+    // MSPv2 frame header and payload, as checksummed by the MSP serial code
+    uint8_t frame[] = { 0x00, 0x64, 0x00, 0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0x00 };
+    sbuf_t buf = { frame + sizeof(frame) - 1, frame + sizeof(frame) };
+
+    uint8_t expected = 0;
+    for (unsigned i = 0; i < sizeof(frame) - 1; i++) {
+        expected = crc8DvbS2Reference(expected, frame[i]);
+    }
+
+    crc8_dvb_s2_sbuf_append(&buf, frame);
+
+    EXPECT_EQ(expected, frame[sizeof(frame) - 1]);
+    EXPECT_EQ(frame + sizeof(frame), buf.ptr);
+
+    // Checksum over the frame including its own CRC is zero
+    EXPECT_EQ(0, crc8_dvb_s2_update(0, frame, sizeof(frame)));
+}
@@ -0,0 +1,150 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/utils.h"
+
+    #include "drivers/dshot_telemetry.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static const uint8_t gcrEncode[16] = {
+    0x19, 0x1b, 0x12, 0x13, 0x1d, 0x15, 0x16, 0x17,
+    0x1a, 0x09, 0x0a, 0x0b, 0x1e, 0x0d, 0x0e, 0x0f
+};
+
+// Edge timestamps of the reply to a 12 bit eRPM value, as captured by a
+// 16 bit timer starting at startTime. Returns the number of edges.
+static int encodeReply(uint16_t value, uint16_t startTime, int jitter, uint32_t *edges)
+{
+    const int csum = ~(value ^ (value >> 4) ^ (value >> 8)) & 0xf;
+    const uint16_t packet = (value << 4) | csum;
+
+    // Start bit, then a transition for every 1 in the GCR code
+    uint32_t bits = 1;
+    for (int nibble = 3; nibble >= 0; nibble--) {
+        bits = (bits << 5) | gcrEncode[(packet >> (nibble * 4)) & 0xf];
+    }
+
+    int count = 0;
+    for (int bit = DSHOT_BIDIR_GCR_BITS - 1; bit >= 0; bit--) {
+        if (bits & (1 << bit)) {
+            const int offset = (count & 1) ? jitter : 0;
+            edges[count] = (uint16_t)(startTime + (DSHOT_BIDIR_GCR_BITS - 1 - bit) * DSHOT_BIDIR_GCR_BITLENGTH + offset);
+            count++;
+        }
+    }
+    return count;
+}
+
+TEST(DshotTelemetryTest, KnownEdgeSequence)
+{
+    // Period 500 << 1 = 1000us, packet 0x3f47, GCR 10011 01111 11101 10111
+    const uint32_t edges[] = { 0, 16, 64, 80, 112, 128, 144, 160, 176, 192, 208, 240, 256, 288, 304, 320 };
+    uint32_t erpm = 0;
+
+    EXPECT_TRUE(dshotDecodeTelemetry(edges, ARRAYLEN(edges), &erpm));
+    EXPECT_EQ(60000u, erpm);
+}
+
+TEST(DshotTelemetryTest, MotorStopped)
+{
+    // Packet 0xfff0, GCR 01111 01111 01111 11001
+    const uint32_t edges[] = { 0, 32, 48, 64, 80, 112, 128, 144, 160, 192, 208, 224, 240, 256, 272, 320 };
+    uint32_t erpm = 1234;
+
+    EXPECT_TRUE(dshotDecodeTelemetry(edges, ARRAYLEN(edges), &erpm));
+    EXPECT_EQ(0u, erpm);
+}
+
+TEST(DshotTelemetryTest, PeriodEncoding)
+{
+    uint32_t edges[DSHOT_BIDIR_GCR_BITS];
+
+    for (int exponent = 0; exponent < 8; exponent++) {
+        for (int mantissa = 1; mantissa < 512; mantissa += 37) {
+            const uint32_t periodUs = mantissa << exponent;
+            const int count = encodeReply((exponent << 9) | mantissa, 1000, 0, edges);
+            uint32_t erpm = 0;
+
+            EXPECT_TRUE(dshotDecodeTelemetry(edges, count, &erpm));
+            EXPECT_EQ((60 * 1000000 + periodUs / 2) / periodUs, erpm);
+        }
+    }
+}
+
+TEST(DshotTelemetryTest, TimerWrapAndJitter)
+{
+    uint32_t edges[DSHOT_BIDIR_GCR_BITS];
+    uint32_t erpm = 0;
+
+    // Timer overflows in the middle of the reply
+    int count = encodeReply(0x3f4, 0xffa0, 0, edges);
+    EXPECT_TRUE(dshotDecodeTelemetry(edges, count, &erpm));
+    EXPECT_EQ(60000u, erpm);
+
+    // Edges off by less than half a bit still decode
+    count = encodeReply(0x3f4, 0xffa0, 7, edges);
+    erpm = 0;
+    EXPECT_TRUE(dshotDecodeTelemetry(edges, count, &erpm));
+    EXPECT_EQ(60000u, erpm);
+}
+
+TEST(DshotTelemetryTest, Corrupted)
+{
+    uint32_t edges[DSHOT_BIDIR_GCR_BITS] = { 0 };
+    uint32_t erpm = 4321;
+
+    // No reply or only the start bit
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, 0, &erpm));
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, 1, &erpm));
+
+    // Missing edge
+    int count = encodeReply(0x3f4, 0, 0, edges);
+    for (int i = 5; i < count - 1; i++) {
+        edges[i] = edges[i + 1];
+    }
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, count - 1, &erpm));
+
+    // Edge moved by a bit, checksum fails
+    count = encodeReply(0x3f4, 0, 0, edges);
+    edges[3] += DSHOT_BIDIR_GCR_BITLENGTH;
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, count, &erpm));
+
+    // Two edges in the same bit
+    count = encodeReply(0x3f4, 0, 0, edges);
+    edges[2] = edges[1] + 2;
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, count, &erpm));
+
+    // Reply longer than 21 bits
+    count = encodeReply(0x3f4, 0, 0, edges);
+    edges[count - 1] += 4 * DSHOT_BIDIR_GCR_BITLENGTH;
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, count, &erpm));
+
+    // Zero period with a valid checksum
+    count = encodeReply(0x200, 0, 0, edges);
+    EXPECT_FALSE(dshotDecodeTelemetry(edges, count, &erpm));
+
+    EXPECT_EQ(4321u, erpm);
+}
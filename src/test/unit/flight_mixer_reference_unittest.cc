@@ -0,0 +1,569 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks mixTable() and servoMixer() against the straightforward per-motor
+// and per-rule formulation they were optimized from, and reports the time
+// spent per call by both.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/build_config.h"
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+    #include "config/feature.h"
+    #include "fc/config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+    #include "flight/failsafe.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/servos.h"
+    #include "navigation/navigation.h"
+    #include "rx/rx.h"
+
+    extern const mixerConfig_t pgResetTemplate_mixerConfig;
+    extern const motorConfig_t pgResetTemplate_motorConfig;
+    extern const flight3DConfig_t pgResetTemplate_flight3DConfig;
+    extern const servoConfig_t pgResetTemplate_servoConfig;
+
+    void pgResetFn_customServoMixers(servoMixer_t *instance);
+    void pgResetFn_servoParams(servoParam_t *instance);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_DT                 0.001f
+#define TEST_ITERATIONS         2000
+#define TEST_BENCH_ITERATIONS   200000
+
+static uint32_t testFeatureMask;
+static bool testFailsafeActive;
+static bool testLogicCondition;
+static int16_t testRxChannels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+static const motorMixer_t octoFlatX[] = {
+    { 1.0f,  1.000000f, -0.414178f,  1.0f },    // REAR_R
+    { 1.0f, -0.414178f, -1.000000f, -1.0f },    // FRONT_R
+    { 1.0f, -1.000000f,  0.414178f,  1.0f },    // MIDFRONT_L
+    { 1.0f,  0.414178f,  1.000000f, -1.0f },    // FRONT_L
+    { 1.0f,  0.414178f, -1.000000f, -1.0f },    // REAR_L
+    { 1.0f, -1.000000f, -0.414178f,  1.0f },    // MIDREAR_L
+    { 1.0f, -0.414178f,  1.000000f,  1.0f },    // MIDFRONT_R
+    { 1.0f,  1.000000f,  0.414178f, -1.0f },    // MIDREAR_R
+};
+
+static const motorMixer_t quadX[] = {
+    { 1.0f, -1.0f,  1.0f, -1.0f },              // REAR_R
+    { 1.0f, -1.0f, -1.0f,  1.0f },              // FRONT_R
+    { 1.0f,  1.0f,  1.0f,  1.0f },              // REAR_L
+    { 1.0f,  1.0f, -1.0f, -1.0f },              // FRONT_L
+};
+
+// Quad with tilting front motors and elevons, the tilt follows CH5 at
+// a limited speed and the elevons are only mixed in when the logic
+// condition is true (forward flight)
+static const servoMixer_t vtolServoRules[] = {
+    { 0, INPUT_RC_CH5, 100, 20, -1 },
+    { 1, INPUT_RC_CH5, -100, 20, -1 },
+    { 0, INPUT_STABILIZED_YAW, 50, 0, -1 },
+    { 1, INPUT_STABILIZED_YAW, 50, 0, -1 },
+    { 2, INPUT_STABILIZED_ROLL, 100, 0, 0 },
+    { 2, INPUT_STABILIZED_PITCH, 100, 0, 0 },
+    { 3, INPUT_STABILIZED_ROLL, 100, 0, 0 },
+    { 3, INPUT_STABILIZED_PITCH, -100, 0, 0 },
+    { 4, INPUT_STABILIZED_THROTTLE, 100, 0, -1 },
+    { 4, INPUT_LOGIC_ONE, 20, 0, -1 },
+    { 5, INPUT_FEATURE_FLAPS, 100, 50, -1 },
+    { 5, INPUT_STABILIZED_PITCH_PLUS, 80, 0, -1 },
+    { 5, INPUT_STABILIZED_YAW_MINUS, -60, 0, -1 },
+    { 6, INPUT_GIMBAL_PITCH, 100, 0, -1 },
+    { 7, INPUT_RC_CH16, 100, 0, -1 },
+};
+
+/*
+ * Reference implementation, mixTable() and servoMixer() as they were
+ * before the mixer matrix and the static servo rules were precomputed
+ */
+static int16_t referenceMotor[MAX_SUPPORTED_MOTORS];
+static int16_t referenceServo[MAX_SUPPORTED_SERVOS];
+
+static void referenceMixTable(const float dT)
+{
+    const int motorCount = getMotorCount();
+    const float mixerScale = feature(FEATURE_3D) ? 0.5f : 1.0f;
+    int throttleCommand;
+
+    int16_t input[3];
+    if (STATE(FIXED_WING) && FLIGHT_MODE(MANUAL_MODE)) {
+        input[ROLL] = rcCommand[ROLL];
+        input[PITCH] = rcCommand[PITCH];
+        input[YAW] = rcCommand[YAW];
+    }
+    else {
+        input[ROLL] = axisPID[ROLL];
+        input[PITCH] = axisPID[PITCH];
+        input[YAW] = axisPID[YAW];
+
+        if (motorCount >= 4 && mixerConfig()->yaw_jump_prevention_limit < YAW_JUMP_PREVENTION_LIMIT_HIGH) {
+            input[YAW] = constrain(input[YAW], -mixerConfig()->yaw_jump_prevention_limit - ABS(rcCommand[YAW]), mixerConfig()->yaw_jump_prevention_limit + ABS(rcCommand[YAW]));
+        }
+    }
+
+    int16_t rpyMix[MAX_SUPPORTED_MOTORS];
+    int16_t rpyMixMax = 0;
+    int16_t rpyMixMin = 0;
+
+    for (int i = 0; i < motorCount; i++) {
+        rpyMix[i] =
+            (input[PITCH] * primaryMotorMixer(i)->pitch +
+            input[ROLL] * primaryMotorMixer(i)->roll +
+            -mixerConfig()->yaw_motor_direction * input[YAW] * primaryMotorMixer(i)->yaw) * mixerScale;
+
+        if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
+        if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
+    }
+
+    int16_t rpyMixRange = rpyMixMax - rpyMixMin;
+    int16_t throttleRange;
+    int16_t throttleMin, throttleMax;
+    static int16_t throttlePrevious = 0;
+
+    if (feature(FEATURE_3D)) {
+        if (!ARMING_FLAG(ARMED)) throttlePrevious = PWM_RANGE_MIDDLE;
+
+        if ((rcCommand[THROTTLE] <= (PWM_RANGE_MIDDLE - rcControlsConfig()->deadband3d_throttle))) {
+            throttleMax = flight3DConfig()->deadband3d_low;
+            throttleMin = motorConfig()->minthrottle;
+            throttlePrevious = throttleCommand = rcCommand[THROTTLE];
+        } else if (rcCommand[THROTTLE] >= (PWM_RANGE_MIDDLE + rcControlsConfig()->deadband3d_throttle)) {
+            throttleMax = motorConfig()->maxthrottle;
+            throttleMin = flight3DConfig()->deadband3d_high;
+            throttlePrevious = throttleCommand = rcCommand[THROTTLE];
+        } else if ((throttlePrevious <= (PWM_RANGE_MIDDLE - rcControlsConfig()->deadband3d_throttle)))  {
+            throttleCommand = throttleMax = flight3DConfig()->deadband3d_low;
+            throttleMin = motorConfig()->minthrottle;
+        } else {
+            throttleMax = motorConfig()->maxthrottle;
+            throttleCommand = throttleMin = flight3DConfig()->deadband3d_high;
+        }
+    } else {
+        throttleCommand = rcCommand[THROTTLE];
+        throttleMin = motorConfig()->minthrottle;
+        throttleMax = motorConfig()->maxthrottle;
+
+        throttleCommand = ((throttleCommand - throttleMin) * motorConfig()->throttleScale) + throttleMin;
+    }
+
+    throttleRange = throttleMax - throttleMin;
+
+    float motorMixRange = (float)rpyMixRange / (float)throttleRange;
+    if (motorMixRange > 1.0f) {
+        for (int i = 0; i < motorCount; i++) {
+            rpyMix[i] /= motorMixRange;
+        }
+
+        throttleMin = throttleMin + (throttleRange / 2) - (throttleRange * 0.33f / 2);
+        throttleMax = throttleMin + (throttleRange / 2) + (throttleRange * 0.33f / 2);
+    } else {
+        throttleMin = MIN(throttleMin + (rpyMixRange / 2), throttleMin + (throttleRange / 2) - (throttleRange * 0.33f / 2));
+        throttleMax = MAX(throttleMax - (rpyMixRange / 2), throttleMin + (throttleRange / 2) + (throttleRange * 0.33f / 2));
+    }
+
+    if (ARMING_FLAG(ARMED)) {
+        for (int i = 0; i < motorCount; i++) {
+            referenceMotor[i] = rpyMix[i] + constrain(throttleCommand * primaryMotorMixer(i)->throttle, throttleMin, throttleMax);
+
+            if (failsafeIsActive()) {
+                referenceMotor[i] = constrain(referenceMotor[i], motorConfig()->mincommand, motorConfig()->maxthrottle);
+            } else if (feature(FEATURE_3D)) {
+                if (throttlePrevious <= (PWM_RANGE_MIDDLE - rcControlsConfig()->deadband3d_throttle)) {
+                    referenceMotor[i] = constrain(referenceMotor[i], motorConfig()->minthrottle, flight3DConfig()->deadband3d_low);
+                } else {
+                    referenceMotor[i] = constrain(referenceMotor[i], flight3DConfig()->deadband3d_high, motorConfig()->maxthrottle);
+                }
+            } else {
+                referenceMotor[i] = constrain(referenceMotor[i], motorConfig()->minthrottle, motorConfig()->maxthrottle);
+            }
+
+            if (ARMING_FLAG(ARMED) && (getMotorStatus() != MOTOR_RUNNING)) {
+                if (feature(FEATURE_MOTOR_STOP)) {
+                    referenceMotor[i] = (feature(FEATURE_3D) ? PWM_RANGE_MIDDLE : motorConfig()->mincommand);
+                } else {
+                    referenceMotor[i] = motorConfig()->minthrottle;
+                }
+            }
+        }
+    } else {
+        for (int i = 0; i < motorCount; i++) {
+            referenceMotor[i] = motor_disarmed[i];
+        }
+    }
+
+    static float motorPrevious[MAX_SUPPORTED_MOTORS] = { 0 };
+
+    if (feature(FEATURE_3D)) {
+        for (int i = 0; i < motorCount; i++) {
+            motorPrevious[i] = referenceMotor[i];
+        }
+    }
+    else {
+        const uint16_t motorRange = motorConfig()->maxthrottle - motorConfig()->minthrottle;
+        const float motorMaxInc = (motorConfig()->motorAccelTimeMs == 0) ? 2000 : motorRange * dT / (motorConfig()->motorAccelTimeMs * 1e-3f);
+        const float motorMaxDec = (motorConfig()->motorDecelTimeMs == 0) ? 2000 : motorRange * dT / (motorConfig()->motorDecelTimeMs * 1e-3f);
+
+        for (int i = 0; i < motorCount; i++) {
+            motorPrevious[i] = constrainf(referenceMotor[i], motorPrevious[i] - motorMaxDec, motorPrevious[i] + motorMaxInc);
+
+            if (motorPrevious[i] < motorConfig()->minthrottle) {
+                if (referenceMotor[i] < motorConfig()->minthrottle) {
+                    motorPrevious[i] = referenceMotor[i];
+                }
+                else {
+                    motorPrevious[i] = motorConfig()->minthrottle;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < motorCount; i++) {
+        referenceMotor[i] = motorPrevious[i];
+    }
+}
+
+// Like servoSpeedLimitFilter[] these are not reset when the rules are reloaded
+static rateLimitFilter_t referenceSpeedLimitFilter[MAX_SERVO_RULES];
+
+static void referenceServoMixer(float dT)
+{
+    int16_t input[INPUT_SOURCE_COUNT];
+
+    if (FLIGHT_MODE(MANUAL_MODE)) {
+        input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
+        input[INPUT_STABILIZED_PITCH] = rcCommand[PITCH];
+        input[INPUT_STABILIZED_YAW] = rcCommand[YAW];
+    } else {
+        input[INPUT_STABILIZED_ROLL] = axisPID[ROLL];
+        input[INPUT_STABILIZED_PITCH] = axisPID[PITCH];
+        input[INPUT_STABILIZED_YAW] = axisPID[YAW];
+
+        if (feature(FEATURE_3D) && (rxGetChannelValue(THROTTLE) < PWM_RANGE_MIDDLE) &&
+        (mixerConfig()->platformType == PLATFORM_MULTIROTOR || mixerConfig()->platformType == PLATFORM_TRICOPTER)) {
+            input[INPUT_STABILIZED_YAW] *= -1;
+        }
+    }
+
+    input[INPUT_STABILIZED_ROLL_PLUS] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
+    input[INPUT_STABILIZED_ROLL_MINUS] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
+    input[INPUT_STABILIZED_PITCH_PLUS] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
+    input[INPUT_STABILIZED_PITCH_MINUS] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
+    input[INPUT_STABILIZED_YAW_PLUS] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
+    input[INPUT_STABILIZED_YAW_MINUS] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
+
+    input[INPUT_FEATURE_FLAPS] = FLIGHT_MODE(FLAPERON) ? servoConfig()->flaperon_throw_offset : 0;
+
+    input[INPUT_LOGIC_ONE] = 500;
+
+    if (IS_RC_MODE_ACTIVE(BOXCAMSTAB)) {
+        input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -900, 900, -500, +500);
+        input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
+    } else {
+        input[INPUT_GIMBAL_PITCH] = 0;
+        input[INPUT_GIMBAL_ROLL] = 0;
+    }
+
+    input[INPUT_STABILIZED_THROTTLE] = mixerThrottleCommand - 1000 - 500;
+
+#define GET_RX_CHANNEL_INPUT(x) (rxGetChannelValue(x) - PWM_RANGE_MIDDLE)
+    input[INPUT_RC_ROLL]     = GET_RX_CHANNEL_INPUT(ROLL);
+    input[INPUT_RC_PITCH]    = GET_RX_CHANNEL_INPUT(PITCH);
+    input[INPUT_RC_YAW]      = GET_RX_CHANNEL_INPUT(YAW);
+    input[INPUT_RC_THROTTLE] = GET_RX_CHANNEL_INPUT(THROTTLE);
+    input[INPUT_RC_CH5]      = GET_RX_CHANNEL_INPUT(AUX1);
+    input[INPUT_RC_CH6]      = GET_RX_CHANNEL_INPUT(AUX2);
+    input[INPUT_RC_CH7]      = GET_RX_CHANNEL_INPUT(AUX3);
+    input[INPUT_RC_CH8]      = GET_RX_CHANNEL_INPUT(AUX4);
+    input[INPUT_RC_CH9]      = GET_RX_CHANNEL_INPUT(AUX5);
+    input[INPUT_RC_CH10]     = GET_RX_CHANNEL_INPUT(AUX6);
+    input[INPUT_RC_CH11]     = GET_RX_CHANNEL_INPUT(AUX7);
+    input[INPUT_RC_CH12]     = GET_RX_CHANNEL_INPUT(AUX8);
+    input[INPUT_RC_CH13]     = GET_RX_CHANNEL_INPUT(AUX9);
+    input[INPUT_RC_CH14]     = GET_RX_CHANNEL_INPUT(AUX10);
+    input[INPUT_RC_CH15]     = GET_RX_CHANNEL_INPUT(AUX11);
+    input[INPUT_RC_CH16]     = GET_RX_CHANNEL_INPUT(AUX12);
+#undef GET_RX_CHANNEL_INPUT
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        referenceServo[i] = 0;
+    }
+
+    for (int i = 0; i < MAX_SERVO_RULES && customServoMixers(i)->rate != 0; i++) {
+        const servoMixer_t *rule = customServoMixers(i);
+
+        if (!logicConditionGetValue(rule->conditionId)) {
+            continue;
+        }
+
+        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&referenceSpeedLimitFilter[i], input[rule->inputSource], rule->speed * 10, dT);
+
+        referenceServo[rule->targetChannel] += ((int32_t)inputLimited * rule->rate) / 100;
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        const float scaleMax = (servoParams(i)->max - servoParams(i)->middle) / 500.0f;
+        const float scaleMin = (servoParams(i)->middle - servoParams(i)->min) / 500.0f;
+
+        referenceServo[i] = ((int32_t)servoParams(i)->rate * referenceServo[i]) / 100L;
+
+        if (referenceServo[i] > 0) {
+            referenceServo[i] = (int16_t) (referenceServo[i] * scaleMax);
+        } else {
+            referenceServo[i] = (int16_t) (referenceServo[i] * scaleMin);
+        }
+
+        referenceServo[i] += servoParams(i)->middle;
+        referenceServo[i] = constrain(referenceServo[i], servoParams(i)->min, servoParams(i)->max);
+    }
+}
+
+/*
+ * Deterministic pseudo random inputs, so failures can be reproduced
+ */
+static uint32_t testRandomState;
+
+static int testRandom(int min, int max)
+{
+    testRandomState = testRandomState * 1664525 + 1013904223;
+    return min + (int)((testRandomState >> 8) % (uint32_t)(max - min + 1));
+}
+
+static void randomizeInputs(void)
+{
+    axisPID[ROLL] = testRandom(-600, 600);
+    axisPID[PITCH] = testRandom(-600, 600);
+    axisPID[YAW] = testRandom(-600, 600);
+
+    rcCommand[ROLL] = testRandom(-500, 500);
+    rcCommand[PITCH] = testRandom(-500, 500);
+    rcCommand[YAW] = testRandom(-500, 500);
+    rcCommand[THROTTLE] = testRandom(1000, 2000);
+
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        testRxChannels[i] = testRandom(1000, 2000);
+    }
+
+    attitude.values.roll = testRandom(-1800, 1800);
+    attitude.values.pitch = testRandom(-900, 900);
+
+    // Change the conditions now and then, but not every loop
+    if (testRandom(0, 50) == 0) {
+        testLogicCondition = !testLogicCondition;
+    }
+    if (testRandom(0, 100) == 0) {
+        testFailsafeActive = !testFailsafeActive;
+    }
+}
+
+static void setupMixer(const motorMixer_t *motorRules, int motorRuleCount, const servoMixer_t *servoRules, int servoRuleCount, uint32_t features)
+{
+    testFeatureMask = features;
+    testFailsafeActive = false;
+    testLogicCondition = true;
+    testRandomState = 1;
+
+    armingFlags = 0;
+    flightModeFlags = 0;
+    stateFlags = 0;
+
+    *mixerConfigMutable() = pgResetTemplate_mixerConfig;
+    *motorConfigMutable() = pgResetTemplate_motorConfig;
+    motorConfigMutable()->motorAccelTimeMs = 50;
+    motorConfigMutable()->motorDecelTimeMs = 100;
+    motorConfigMutable()->throttleScale = 0.9f;
+    *flight3DConfigMutable() = pgResetTemplate_flight3DConfig;
+    *servoConfigMutable() = pgResetTemplate_servoConfig;
+    rxConfigMutable()->mincheck = 1100;
+    rcControlsConfigMutable()->deadband3d_throttle = 50;
+
+    memset(primaryMotorMixer_SystemArray, 0, sizeof(primaryMotorMixer_SystemArray));
+    memcpy(primaryMotorMixer_SystemArray, motorRules, motorRuleCount * sizeof(motorMixer_t));
+
+    pgResetFn_customServoMixers(customServoMixers_SystemArray);
+    memcpy(customServoMixers_SystemArray, servoRules, servoRuleCount * sizeof(servoMixer_t));
+
+    pgResetFn_servoParams(servoParams_SystemArray);
+    servoParamsMutable(1)->rate = -100;
+    servoParamsMutable(2)->min = 1100;
+    servoParamsMutable(2)->middle = 1450;
+    servoParamsMutable(2)->max = 1900;
+    servoParamsMutable(4)->rate = 150;
+    servoParamsMutable(5)->rate = 75;
+
+    mixerUpdateStateFlags();
+    mixerInit();
+    servosInit();
+}
+
+static void expectMatchesReference(void)
+{
+    for (int i = 0; i < getMotorCount(); i++) {
+        EXPECT_EQ(referenceMotor[i], motor[i]) << "motor " << i;
+    }
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        EXPECT_EQ(referenceServo[i], servo[i]) << "servo " << i;
+    }
+}
+
+static void runAgainstReference(void)
+{
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        randomizeInputs();
+
+        // Arm after a few loops, and keep the motors stopped by the
+        // throttle stick from time to time
+        if (i == 10) {
+            ENABLE_ARMING_FLAG(ARMED);
+        }
+        if (i % 200 < 20) {
+            testRxChannels[THROTTLE] = 1000;
+        }
+
+        mixTable(TEST_DT);
+        referenceMixTable(TEST_DT);
+        servoMixer(TEST_DT);
+        referenceServoMixer(TEST_DT);
+
+        expectMatchesReference();
+        if (::testing::Test::HasFailure()) {
+            printf("[  FAILED  ] mismatch at iteration %d\n", i);
+            return;
+        }
+    }
+}
+
+template <typename F>
+static double nanosecondsPerCall(F fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        fn(TEST_DT);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / TEST_BENCH_ITERATIONS;
+}
+
+static void printTimePerCall(const char *name)
+{
+    ENABLE_ARMING_FLAG(ARMED);
+    randomizeInputs();
+
+    // Unoptimized host build, only the ratio is meaningful
+    printf("[ BENCH    ] %s mixTable: %.1f ns/call, reference %.1f ns/call\n", name,
+        nanosecondsPerCall(mixTable), nanosecondsPerCall(referenceMixTable));
+    printf("[ BENCH    ] %s servoMixer: %.1f ns/call, reference %.1f ns/call\n", name,
+        nanosecondsPerCall(servoMixer), nanosecondsPerCall(referenceServoMixer));
+}
+
+TEST(FlightMixerReferenceTest, Octo)
+{
+    setupMixer(octoFlatX, ARRAYLEN(octoFlatX), NULL, 0, 0);
+    EXPECT_EQ(8, getMotorCount());
+
+    runAgainstReference();
+    printTimePerCall("octo");
+}
+
+TEST(FlightMixerReferenceTest, OctoMotorStopReversedYaw)
+{
+    setupMixer(octoFlatX, ARRAYLEN(octoFlatX), NULL, 0, FEATURE_MOTOR_STOP);
+
+    runAgainstReference();
+
+    // yaw_motor_direction changed at runtime
+    mixerConfigMutable()->yaw_motor_direction = -1;
+    runAgainstReference();
+}
+
+TEST(FlightMixerReferenceTest, Vtol)
+{
+    setupMixer(quadX, ARRAYLEN(quadX), vtolServoRules, ARRAYLEN(vtolServoRules), 0);
+    EXPECT_EQ(4, getMotorCount());
+
+    ENABLE_FLIGHT_MODE(FLAPERON);
+    runAgainstReference();
+    DISABLE_FLIGHT_MODE(FLAPERON);
+    ENABLE_FLIGHT_MODE(MANUAL_MODE);
+    runAgainstReference();
+    printTimePerCall("vtol");
+}
+
+// Must run last, mixerInit() doesn't restore the mixer scale when 3D is disabled
+TEST(FlightMixerReferenceTest, Vtol3D)
+{
+    setupMixer(quadX, ARRAYLEN(quadX), vtolServoRules, ARRAYLEN(vtolServoRules), FEATURE_3D);
+
+    runAgainstReference();
+}
+
+// STUBS
+
+extern "C" {
+uint32_t armingFlags;
+uint32_t flightModeFlags;
+uint32_t stateFlags;
+
+int16_t rcCommand[4];
+int16_t axisPID[FLIGHT_DYNAMICS_INDEX_COUNT];
+attitudeEulerAngles_t attitude;
+
+rxConfig_t rxConfig_System;
+rcControlsConfig_t rcControlsConfig_System;
+navConfig_t navConfig_System;
+
+bool feature(uint32_t mask) { return (testFeatureMask & mask) != 0; }
+uint32_t enableFlightMode(flightModeFlags_e mask) { flightModeFlags |= mask; return flightModeFlags; }
+uint32_t disableFlightMode(flightModeFlags_e mask) { flightModeFlags &= ~mask; return flightModeFlags; }
+bool IS_RC_MODE_ACTIVE(boxId_e boxId) { return boxId == BOXCAMSTAB; }
+int16_t rxGetChannelValue(unsigned channelNumber) { return testRxChannels[channelNumber]; }
+bool failsafeIsActive(void) { return testFailsafeActive; }
+bool failsafeRequiresMotorStop(void) { return false; }
+bool navigationIsFlyingAutonomousMode(void) { return false; }
+bool isAmperageConfigured(void) { return false; }
+float calculateThrottleCompensationFactor(void) { return 1.0f; }
+int logicConditionGetValue(int8_t conditionId) { return conditionId < 0 || testLogicCondition; }
+void pidResetErrorAccumulators(void) {}
+void pidSelectRateController(void) {}
+void saveConfigAndNotify(void) {}
+uint32_t getLooptime(void) { return 1000; }
+timeMs_t millis(void) { return 0; }
+void delay(timeMs_t) {}
+void pwmWriteMotor(uint8_t, uint16_t) {}
+void pwmShutdownPulsesForAllMotors(uint8_t) {}
+void pwmWriteServo(uint8_t, uint16_t) {}
+}
@@ -0,0 +1,293 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/build_config.h"
+    #include "common/maths.h"
+    #include "common/quaternion.h"
+    #include "common/vector.h"
+    #include "flight/imu_ekf.h"
+
+    extern float ekfP[EKF_STATE_COUNT][EKF_STATE_COUNT];
+    extern float ekfX[EKF_STATE_COUNT];
+
+    STATIC_UNIT_TESTED void ekfPredictCovariance(const fpVector3_t * dAngle, const fpVector3_t * dVelocity, float dt);
+    STATIC_UNIT_TESTED bool ekfScalarUpdate(const float H[EKF_STATE_COUNT], float measurement, float R, bool useGate);
+    STATIC_UNIT_TESTED float ekfPredictGravity(int axis, float H[EKF_STATE_COUNT]);
+    STATIC_UNIT_TESTED float ekfPredictSideslip(float H[EKF_STATE_COUNT]);
+    STATIC_UNIT_TESTED float ekfPredictAirspeed(float H[EKF_STATE_COUNT]);
+    STATIC_UNIT_TESTED void ekfApplyCorrection(void);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+typedef float (*ekfMeasurementFn)(float H[EKF_STATE_COUNT]);
+
+static fpQuaternion_t testOrientation(void)
+{
+    fpQuaternion_t q = { .q0 = 0.9f, .q1 = 0.2f, .q2 = -0.1f, .q3 = 0.35f };
+    quaternionNormalize(&q, &q);
+    return q;
+}
+
+// Moves the nominal state by a single error state component
+static void injectError(int index, float value)
+{
+    ekfX[index] = value;
+    ekfApplyCorrection();
+}
+
+static void setAirVelocity(void)
+{
+    injectError(EKF_VEL + 0, 1500.0f);
+    injectError(EKF_VEL + 1, -300.0f);
+    injectError(EKF_VEL + 2, 100.0f);
+    injectError(EKF_WIND + 0, 200.0f);
+    injectError(EKF_WIND + 1, 400.0f);
+}
+
+// Compares the analytic Jacobian with central differences over every error state
+static void expectJacobian(ekfMeasurementFn measurement)
+{
+    float H[EKF_STATE_COUNT];
+    float unused[EKF_STATE_COUNT];
+
+    measurement(H);
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        const float eps = (i < EKF_ATT + 3) ? 1e-3f : 1.0f;
+
+        injectError(i, eps);
+        const float hPlus = measurement(unused);
+        injectError(i, -2.0f * eps);
+        const float hMinus = measurement(unused);
+        injectError(i, eps);
+
+        const float numeric = (hPlus - hMinus) / (2.0f * eps);
+        EXPECT_NEAR(H[i], numeric, 0.05f + 0.002f * fabsf(H[i])) << "state " << i;
+    }
+}
+
+static int gravityAxis;
+
+static float predictGravity(float H[EKF_STATE_COUNT])
+{
+    return ekfPredictGravity(gravityAxis, H);
+}
+
+// Symmetric positive definite matrix with a spread of magnitudes and correlations
+static void fillCovariance(float P[EKF_STATE_COUNT][EKF_STATE_COUNT])
+{
+    float A[EKF_STATE_COUNT][EKF_STATE_COUNT];
+    uint32_t seed = 12345;
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            seed = seed * 1103515245 + 12345;
+            A[i][j] = ((int)((seed >> 16) & 0xFF) - 128) / 128.0f;
+        }
+    }
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            float sum = (i == j) ? 1.0f : 0.0f;
+            for (int k = 0; k < EKF_STATE_COUNT; k++) {
+                sum += A[i][k] * A[j][k];
+            }
+            P[i][j] = sum;
+        }
+    }
+}
+
+TEST(ImuEkfTest, GravityJacobian)
+{
+    const fpQuaternion_t q = testOrientation();
+    imuEkfReset(&q);
+
+    for (gravityAxis = 0; gravityAxis < 3; gravityAxis++) {
+        expectJacobian(predictGravity);
+    }
+}
+
+TEST(ImuEkfTest, SideslipJacobian)
+{
+    const fpQuaternion_t q = testOrientation();
+    imuEkfReset(&q);
+    setAirVelocity();
+
+    expectJacobian(ekfPredictSideslip);
+}
+
+TEST(ImuEkfTest, AirspeedJacobian)
+{
+    const fpQuaternion_t q = testOrientation();
+    imuEkfReset(&q);
+    setAirVelocity();
+
+    float H[EKF_STATE_COUNT];
+    EXPECT_NEAR(sqrtf(sq(1300.0f) + sq(700.0f) + sq(100.0f)), ekfPredictAirspeed(H), 0.1f);
+
+    expectJacobian(ekfPredictAirspeed);
+}
+
+TEST(ImuEkfTest, CovariancePredictionMatchesDenseTransition)
+{
+    const fpQuaternion_t q = testOrientation();
+    const fpVector3_t dAngle = { .v = { 0.01f, -0.02f, 0.005f } };
+    const fpVector3_t dVelocity = { .v = { 30.0f, -10.0f, 9.8f } };
+    const float dt = 0.01f;
+    float P[EKF_STATE_COUNT][EKF_STATE_COUNT];
+    float F[EKF_STATE_COUNT][EKF_STATE_COUNT] = { { 0 } };
+
+    imuEkfReset(&q);
+    fillCovariance(P);
+    memcpy(ekfP, P, sizeof(P));
+
+    ekfPredictCovariance(&dAngle, &dVelocity, dt);
+
+    // Body to earth rotation matrix
+    const float R[3][3] = {
+        { 1 - 2 * (sq(q.q2) + sq(q.q3)),  2 * (q.q1 * q.q2 - q.q0 * q.q3), 2 * (q.q1 * q.q3 + q.q0 * q.q2) },
+        { 2 * (q.q1 * q.q2 + q.q0 * q.q3), 1 - 2 * (sq(q.q1) + sq(q.q3)),  2 * (q.q2 * q.q3 - q.q0 * q.q1) },
+        { 2 * (q.q1 * q.q3 - q.q0 * q.q2), 2 * (q.q2 * q.q3 + q.q0 * q.q1), 1 - 2 * (sq(q.q1) + sq(q.q2)) },
+    };
+    const float dVx[3][3] = {
+        { 0, -dVelocity.z, dVelocity.y },
+        { dVelocity.z, 0, -dVelocity.x },
+        { -dVelocity.y, dVelocity.x, 0 },
+    };
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        F[i][i] = 1.0f;
+    }
+
+    // Attitude: I - [dAngle x], -I dt to gyro bias
+    F[EKF_ATT + 0][EKF_ATT + 1] =  dAngle.z;
+    F[EKF_ATT + 0][EKF_ATT + 2] = -dAngle.y;
+    F[EKF_ATT + 1][EKF_ATT + 0] = -dAngle.z;
+    F[EKF_ATT + 1][EKF_ATT + 2] =  dAngle.x;
+    F[EKF_ATT + 2][EKF_ATT + 0] =  dAngle.y;
+    F[EKF_ATT + 2][EKF_ATT + 1] = -dAngle.x;
+
+    for (int i = 0; i < 3; i++) {
+        F[EKF_ATT + i][EKF_GYRO_BIAS + i] = -dt;
+        F[EKF_POS + i][EKF_VEL + i] = dt;
+
+        // Velocity: -[dV x] * R
+        for (int j = 0; j < 3; j++) {
+            float sum = 0;
+            for (int k = 0; k < 3; k++) {
+                sum += dVx[i][k] * R[k][j];
+            }
+            F[EKF_VEL + i][EKF_ATT + j] = -sum;
+        }
+    }
+
+    F[EKF_VEL + 2][EKF_ACC_BIAS_Z] = -dt;
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            double expected = 0;
+            for (int k = 0; k < EKF_STATE_COUNT; k++) {
+                for (int l = 0; l < EKF_STATE_COUNT; l++) {
+                    expected += (double)F[i][k] * P[k][l] * F[j][l];
+                }
+            }
+            EXPECT_NEAR(expected, ekfP[i][j], 1e-4 * fmax(1.0, fabs(expected))) << "P[" << i << "][" << j << "]";
+            EXPECT_EQ(ekfP[i][j], ekfP[j][i]);
+        }
+    }
+}
+
+TEST(ImuEkfTest, ScalarUpdateMatchesKalmanGain)
+{
+    const fpQuaternion_t q = testOrientation();
+    float P[EKF_STATE_COUNT][EKF_STATE_COUNT];
+    float H[EKF_STATE_COUNT];
+    const float R = 2.0f;
+    const float innovation = 0.7f;
+
+    imuEkfReset(&q);
+    fillCovariance(P);
+    memcpy(ekfP, P, sizeof(P));
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        H[i] = (i % 3) - 1.0f + 0.1f * i;
+    }
+
+    EXPECT_TRUE(ekfScalarUpdate(H, innovation, R, false));
+
+    float PHt[EKF_STATE_COUNT];
+    double S = R;
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        PHt[i] = 0;
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            PHt[i] += P[i][j] * H[j];
+        }
+        S += H[i] * PHt[i];
+    }
+
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        EXPECT_NEAR(PHt[i] / S * innovation, ekfX[i], 1e-4);
+
+        for (int j = 0; j < EKF_STATE_COUNT; j++) {
+            const double expected = P[i][j] - PHt[i] * PHt[j] / S;
+            EXPECT_NEAR(expected, ekfP[i][j], 1e-3 * fmax(1.0, fabs(expected)));
+        }
+    }
+
+    // A second measurement of the same quantity is relative to the already updated estimate
+    float Hx = 0;
+    for (int i = 0; i < EKF_STATE_COUNT; i++) {
+        Hx += H[i] * ekfX[i];
+    }
+    EXPECT_LT(fabsf(innovation - Hx), fabsf(innovation));
+}
+
+TEST(ImuEkfTest, ScalarUpdateGate)
+{
+    const fpQuaternion_t q = testOrientation();
+    float H[EKF_STATE_COUNT] = { 0 };
+    float P[EKF_STATE_COUNT][EKF_STATE_COUNT];
+
+    imuEkfReset(&q);
+    memcpy(P, ekfP, sizeof(P));
+    H[EKF_GYRO_BIAS] = 1.0f;
+
+    // Innovation far outside of the predicted distribution is rejected and nothing changes
+    const float sigma = sqrtf(ekfP[EKF_GYRO_BIAS][EKF_GYRO_BIAS] + 1e-4f);
+    EXPECT_FALSE(ekfScalarUpdate(H, 10.0f * sigma, 1e-4f, true));
+    EXPECT_EQ(0, memcmp(P, ekfP, sizeof(P)));
+    EXPECT_EQ(0.0f, ekfX[EKF_GYRO_BIAS]);
+
+    // Within the gate it's used
+    EXPECT_TRUE(ekfScalarUpdate(H, 2.0f * sigma, 1e-4f, true));
+    EXPECT_GT(ekfX[EKF_GYRO_BIAS], 0.0f);
+    EXPECT_LT(ekfP[EKF_GYRO_BIAS][EKF_GYRO_BIAS], P[EKF_GYRO_BIAS][EKF_GYRO_BIAS]);
+
+    // Without the gate everything is used
+    imuEkfReset(&q);
+    EXPECT_TRUE(ekfScalarUpdate(H, 10.0f * sigma, 1e-4f, false));
+}
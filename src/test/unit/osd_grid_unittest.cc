@@ -0,0 +1,228 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "drivers/osd.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define GRID_POS(x, y) ((y) * OSD_CHARACTER_GRID_MAX_WIDTH + (x))
+
+static void resetGrid(void)
+{
+    osdCharacterGridBufferClear();
+    osdCharacterGridBufferClearAllDirty();
+}
+
+TEST(OsdGridTest, WriteMarksDirty)
+{
+    resetGrid();
+
+    EXPECT_TRUE(osdCharacterGridBufferWrite(GRID_POS(3, 2), 'A'));
+    EXPECT_EQ('A', *osdCharacterGridBufferGetEntryPtr(3, 2));
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(3, 2)));
+    EXPECT_FALSE(osdCharacterGridBufferIsDirty(GRID_POS(4, 2)));
+
+    // Same value again doesn't change anything
+    osdCharacterGridBufferClearDirty(GRID_POS(3, 2));
+    EXPECT_FALSE(osdCharacterGridBufferWrite(GRID_POS(3, 2), 'A'));
+    EXPECT_FALSE(osdCharacterGridBufferIsDirty(GRID_POS(3, 2)));
+
+    EXPECT_FALSE(osdCharacterGridBufferWrite(OSD_CHARACTER_GRID_BUFFER_SIZE, 'A'));
+}
+
+TEST(OsdGridTest, NoDirtySpan)
+{
+    unsigned length = 1234;
+
+    resetGrid();
+
+    EXPECT_EQ(-1, osdCharacterGridBufferFindDirtySpan(0, &length));
+    EXPECT_EQ(1234u, length);
+
+    osdCharacterGridBufferWrite(GRID_POS(5, 5), 'A');
+    EXPECT_EQ(-1, osdCharacterGridBufferFindDirtySpan(GRID_POS(6, 5), &length));
+}
+
+TEST(OsdGridTest, DirtySpans)
+{
+    unsigned length = 0;
+
+    resetGrid();
+
+    osdCharacterGridBufferWrite(GRID_POS(2, 1), 'A');
+    for (int x = 10; x < 15; x++) {
+        osdCharacterGridBufferWrite(GRID_POS(x, 1), 'B');
+    }
+    osdCharacterGridBufferSetDirty(GRID_POS(0, 7));
+
+    EXPECT_EQ(GRID_POS(2, 1), osdCharacterGridBufferFindDirtySpan(0, &length));
+    EXPECT_EQ(1u, length);
+
+    EXPECT_EQ(GRID_POS(10, 1), osdCharacterGridBufferFindDirtySpan(GRID_POS(3, 1), &length));
+    EXPECT_EQ(5u, length);
+
+    // Starting inside a span
+    EXPECT_EQ(GRID_POS(12, 1), osdCharacterGridBufferFindDirtySpan(GRID_POS(12, 1), &length));
+    EXPECT_EQ(3u, length);
+
+    EXPECT_EQ(GRID_POS(0, 7), osdCharacterGridBufferFindDirtySpan(GRID_POS(15, 1), &length));
+    EXPECT_EQ(1u, length);
+
+    EXPECT_EQ(-1, osdCharacterGridBufferFindDirtySpan(GRID_POS(1, 7), &length));
+}
+
+TEST(OsdGridTest, DirtySpanStopsAtRowEnd)
+{
+    unsigned length = 0;
+
+    resetGrid();
+
+    for (int pos = GRID_POS(OSD_CHARACTER_GRID_MAX_WIDTH - 3, 4); pos < GRID_POS(4, 5); pos++) {
+        osdCharacterGridBufferWrite(pos, 'C');
+    }
+
+    EXPECT_EQ(GRID_POS(OSD_CHARACTER_GRID_MAX_WIDTH - 3, 4), osdCharacterGridBufferFindDirtySpan(0, &length));
+    EXPECT_EQ(3u, length);
+
+    EXPECT_EQ(GRID_POS(0, 5), osdCharacterGridBufferFindDirtySpan(GRID_POS(0, 5), &length));
+    EXPECT_EQ(4u, length);
+
+    // Last entry of the grid
+    resetGrid();
+    osdCharacterGridBufferWrite(OSD_CHARACTER_GRID_BUFFER_SIZE - 1, 'D');
+    EXPECT_EQ(OSD_CHARACTER_GRID_BUFFER_SIZE - 1, osdCharacterGridBufferFindDirtySpan(0, &length));
+    EXPECT_EQ(1u, length);
+}
+
+TEST(OsdGridTest, AllDirty)
+{
+    unsigned length = 0;
+
+    resetGrid();
+
+    osdCharacterGridBufferSetAllDirty();
+    for (int y = 0; y < OSD_CHARACTER_GRID_MAX_HEIGHT; y++) {
+        EXPECT_EQ(GRID_POS(0, y), osdCharacterGridBufferFindDirtySpan(GRID_POS(0, y), &length));
+        EXPECT_EQ((unsigned)OSD_CHARACTER_GRID_MAX_WIDTH, length);
+    }
+
+    osdCharacterGridBufferClearAllDirty();
+    EXPECT_EQ(-1, osdCharacterGridBufferFindDirtySpan(0, &length));
+}
+
+TEST(OsdGridTest, FrameDropsNetUnchangedEntries)
+{
+    resetGrid();
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), 'A');
+    osdCharacterGridBufferWrite(GRID_POS(2, 1), 'B');
+    osdCharacterGridBufferClearAllDirty();
+
+    // Element erased and drawn again in the same place, another one moved
+    osdCharacterGridBufferBeginFrame();
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), ' ');
+    osdCharacterGridBufferWrite(GRID_POS(2, 1), ' ');
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), 'A');
+    osdCharacterGridBufferWrite(GRID_POS(3, 1), 'B');
+    osdCharacterGridBufferCommitFrame();
+
+    EXPECT_FALSE(osdCharacterGridBufferIsDirty(GRID_POS(1, 1)));
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(2, 1)));
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(3, 1)));
+}
+
+TEST(OsdGridTest, FrameKeepsEntriesDirtyBeforeIt)
+{
+    resetGrid();
+
+    // Not sent to the device yet, must stay dirty even though the frame
+    // writes back the value it had when the frame started
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), 'A');
+
+    osdCharacterGridBufferBeginFrame();
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), ' ');
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), 'A');
+    osdCharacterGridBufferCommitFrame();
+
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(1, 1)));
+}
+
+TEST(OsdGridTest, LargeFrame)
+{
+    resetGrid();
+
+    // Map and sidebar style frame touching a good part of the screen
+    osdCharacterGridBufferBeginFrame();
+    for (int pos = 0; pos < OSD_CHARACTER_GRID_BUFFER_SIZE; pos++) {
+        osdCharacterGridBufferWrite(pos, 'E');
+    }
+    for (int pos = 0; pos < OSD_CHARACTER_GRID_BUFFER_SIZE; pos++) {
+        osdCharacterGridBufferWrite(pos, (pos % 7) ? 0 : 'F');
+    }
+    osdCharacterGridBufferCommitFrame();
+
+    for (int pos = 0; pos < OSD_CHARACTER_GRID_BUFFER_SIZE; pos++) {
+        EXPECT_EQ((pos % 7) == 0, osdCharacterGridBufferIsDirty(pos)) << "pos " << pos;
+    }
+}
+
+TEST(OsdGridTest, FrameAfterDeviceChanges)
+{
+    resetGrid();
+
+    osdCharacterGridBufferBeginFrame();
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), 'A');
+    osdCharacterGridBufferWrite(GRID_POS(2, 1), 'B');
+    // Backend sent (2, 1) and must resend (3, 1) in the middle of the frame
+    osdCharacterGridBufferClearDirty(GRID_POS(2, 1));
+    osdCharacterGridBufferSetDirty(GRID_POS(3, 1));
+    osdCharacterGridBufferWrite(GRID_POS(1, 1), 0);
+    osdCharacterGridBufferWrite(GRID_POS(2, 1), 0);
+    osdCharacterGridBufferWrite(GRID_POS(3, 1), 'C');
+    osdCharacterGridBufferWrite(GRID_POS(3, 1), 0);
+    osdCharacterGridBufferCommitFrame();
+
+    EXPECT_FALSE(osdCharacterGridBufferIsDirty(GRID_POS(1, 1)));
+    // Device shows 'B' now
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(2, 1)));
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(3, 1)));
+
+    // Writes after the frame was committed aren't tracked
+    osdCharacterGridBufferClearAllDirty();
+    osdCharacterGridBufferWrite(GRID_POS(2, 2), 'A');
+    osdCharacterGridBufferWrite(GRID_POS(2, 2), 0);
+    EXPECT_TRUE(osdCharacterGridBufferIsDirty(GRID_POS(2, 2)));
+}
+
+TEST(OsdGridTest, HasDirty)
+{
+    resetGrid();
+    EXPECT_FALSE(osdCharacterGridBufferHasDirty());
+
+    osdCharacterGridBufferWrite(OSD_CHARACTER_GRID_BUFFER_SIZE - 1, 'A');
+    EXPECT_TRUE(osdCharacterGridBufferHasDirty());
+
+    osdCharacterGridBufferClearDirty(OSD_CHARACTER_GRID_BUFFER_SIZE - 1);
+    EXPECT_FALSE(osdCharacterGridBufferHasDirty());
+}
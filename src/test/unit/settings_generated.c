@@ -0,0 +1,77 @@
+// Trimmed down output of utils/settings.rb for settings_unittest, see
+// settings_generated.h
+
+#include "platform.h"
+#include "config/parameter_group_ids.h"
+#include "common/axis.h"
+#include "common/maths.h"
+#include "fc/settings.h"
+#include "fc/config.h"
+#include "fc/controlrate_profile.h"
+#include "flight/pid.h"
+#include "sensors/battery.h"
+const pgn_t settingsPgn[] = {
+	PG_RESERVED_FOR_TESTING_1,
+};
+const uint8_t settingsPgnCounts[] = {
+	14,
+};
+static const uint8_t settingNamesWords[] = {
+	0x70,0x6c, /* "nav" */
+	0x3,0x5c, /* "fw" */
+	0xd,0x18, /* "mc" */
+	0x1f,0x32, /* "osd" */
+	0x2,0x41,0xa1, /* "rate" */
+	0x41,0x0, /* "p" */
+	0x25,0xc1,0xb0, /* "inav" */
+	0x32,0x1b, /* "yaw" */
+	0x81,0xa9,0x70, /* "min" */
+	0x1a,0x1c, /* "max" */
+	0x3,0x40, /* "z" */
+	0xb,0x3,0x26, /* "alarm" */
+	0x80,0xc1,0x4b,0x26,0x13,0x14, /* "failsafe" */
+	0x8,0xd0, /* "hz" */
+	0x20,0x9a,0xd,0x0, /* "pitch" */
+	0x8,0xc6, /* "acc" */
+	0x0,0xb8,0xec,0x28, /* "angle" */
+	0x24,0xf6,0x30, /* "roll" */
+	0x17, /* "w" */
+	0x6,0x32, /* "xy" */
+	0x4, /* "i" */
+	0x81,0x81,0xab,0x86,0x80, /* "launch" */
+	0x41,0xf3, /* "pos" */
+	0x5,0x12,0xd2, /* "time" */
+	0x80,0x2c,0x49,0xdc, /* "align" */
+};
+static const char wordSymbols[] = {'3','1','2','_',};
+const char * const table_off_on[] = {
+	"OFF",
+	"ON",
+};
+static const lookupTableEntry_t settingLookupTables[] = {
+	{ table_off_on, sizeof(table_off_on) / sizeof(char*) },
+};
+static const uint32_t settingMinMaxTable[] = {
+	0,
+	100,
+};
+typedef uint8_t setting_min_max_idx_t;
+#define SETTING_INDEXES_GET_MIN(val) (val->config.minmax.indexes[0])
+#define SETTING_INDEXES_GET_MAX(val) (val->config.minmax.indexes[1])
+static const setting_t settingsTable[] = {
+	// PG_RESERVED_FOR_TESTING_1
+	{ {1, 2, 22, 24, 0, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 0 },
+	{ {1, 2, 22, 9, 24, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 1 },
+	{ {1, 2, 22, 10, 17, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 2 },
+	{ {1, 2, 22, 0, 0, 0}, VAR_UINT8 | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON }, 3 },
+	{ {1, 2, 23, 20, 6, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 4 },
+	{ {1, 2, 23, 11, 6, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 5 },
+	{ {1, 3, 23, 11, 6, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 6 },
+	{ {1, 3, 23, 20, 6, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 7 },
+	{ {1, 3, 23, 20, 21, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 8 },
+	{ {13, 24, 0, 0, 0, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 9 },
+	{ {4, 12, 18, 17, 10, 14}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 10 },
+	{ {8, 5, 0, 0, 0, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 11 },
+	{ {6, 0, 0, 0, 0, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 12 },
+	{ {16, 14, 0, 0, 0, 0}, VAR_UINT8 | MASTER_VALUE, .config.minmax.indexes = {0, 1}, 13 },
+};
@@ -0,0 +1,19 @@
+// Trimmed down output of utils/settings.rb for settings_unittest. The word
+// list is the head of the real one, the names are made up from those words.
+
+#pragma once
+#define SETTING_MAX_NAME_LENGTH 28
+#define SETTING_MAX_WORD_LENGTH 9
+#define SETTING_ENCODED_NAME_MAX_BYTES 6
+#define SETTINGS_WORDS_BITS_PER_CHAR 5
+#define SETTINGS_TABLE_COUNT 14
+typedef uint8_t setting_offset_t;
+#define SETTINGS_PGN_COUNT 1
+typedef int16_t setting_min_t;
+typedef uint32_t setting_max_t;
+#define SETTING_MIN_MAX_INDEX_BYTES 2
+enum {
+	TABLE_OFF_ON,
+	LOOKUP_TABLE_COUNT,
+};
+extern const char * const table_off_on[];
@@ -0,0 +1,139 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/utils.h"
+
+    #include "config/parameter_group.h"
+
+    #include "fc/settings.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Names of the settings in unit/settings_generated.c, in table order
+static const char * const settingNames[] = {
+    "nav_fw_launch_time",
+    "nav_fw_launch_min_time",
+    "nav_fw_launch_max_angle",
+    "nav_fw_launch",
+    "nav_fw_pos_xy_p",
+    "nav_fw_pos_z_p",
+    "nav_mc_pos_z_p",
+    "nav_mc_pos_xy_p",
+    "nav_mc_pos_xy_i",
+    "failsafe_time",
+    "osd_alarm_roll_angle_max_hz",
+    "yaw_rate",
+    "p",
+    "acc_hz",
+};
+
+static void expectSettingName(unsigned index)
+{
+    char buf[SETTING_MAX_NAME_LENGTH];
+
+    memset(buf, 'x', sizeof(buf));
+    settingGetName(settingGet(index), buf);
+    EXPECT_STREQ(settingNames[index], buf) << "setting " << index;
+}
+
+TEST(SettingsTest, TableCount)
+{
+    EXPECT_EQ(ARRAYLEN(settingNames), (unsigned)SETTINGS_TABLE_COUNT);
+}
+
+TEST(SettingsTest, NamesInTableOrder)
+{
+    // Twice, so the second pass starts with the cache holding the last name
+    for (int pass = 0; pass < 2; pass++) {
+        for (unsigned ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
+            expectSettingName(ii);
+        }
+    }
+}
+
+TEST(SettingsTest, NamesInReverseOrder)
+{
+    for (int ii = SETTINGS_TABLE_COUNT - 1; ii >= 0; ii--) {
+        expectSettingName(ii);
+    }
+}
+
+TEST(SettingsTest, NamesOutOfOrder)
+{
+    // 5 is coprime to the table size, so every setting is visited
+    for (unsigned ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
+        expectSettingName((ii * 5) % SETTINGS_TABLE_COUNT);
+    }
+
+    // Same setting again, a longer name after its own prefix and back
+    expectSettingName(3);
+    expectSettingName(3);
+    expectSettingName(0);
+    expectSettingName(3);
+    expectSettingName(10);
+    expectSettingName(12);
+    expectSettingName(10);
+}
+
+TEST(SettingsTest, NameBuffersAreIndependent)
+{
+    char first[SETTING_MAX_NAME_LENGTH];
+    char second[SETTING_MAX_NAME_LENGTH];
+
+    settingGetName(settingGet(1), first);
+    settingGetName(settingGet(2), second);
+
+    EXPECT_STREQ(settingNames[1], first);
+    EXPECT_STREQ(settingNames[2], second);
+}
+
+TEST(SettingsTest, Find)
+{
+    for (unsigned ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
+        EXPECT_EQ(settingGet(ii), settingFind(settingNames[ii]));
+    }
+
+    EXPECT_EQ(NULL, settingFind("nav_fw"));
+    EXPECT_EQ(NULL, settingFind("nav_fw_launch_"));
+    EXPECT_EQ(NULL, settingFind("nav_fw_launch_time_max"));
+}
+
+TEST(SettingsTest, NameMatch)
+{
+    char buf[SETTING_MAX_NAME_LENGTH];
+
+    EXPECT_TRUE(settingNameContains(settingGet(7), buf, "pos_xy"));
+    EXPECT_FALSE(settingNameContains(settingGet(6), buf, "pos_xy"));
+    EXPECT_TRUE(settingNameIsExactMatch(settingGet(4), buf, "NAV_FW_POS_XY_P", strlen("NAV_FW_POS_XY_P")));
+    EXPECT_FALSE(settingNameIsExactMatch(settingGet(3), buf, "nav_fw_launch_time", strlen("nav_fw_launch_time")));
+}
+
+// STUBS
+
+extern "C" {
+const pgRegistry_t *pgFind(pgn_t) { return NULL; }
+uint8_t getConfigProfile(void) { return 0; }
+uint8_t getConfigBatteryProfile(void) { return 0; }
+}